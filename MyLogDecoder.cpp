@@ -0,0 +1,30 @@
+#include "MyLogger.h"
+
+#include <cstdio>
+
+// Renders a log file written with LoggerConfig::binary as the usual text lines
+// Usage: MyLogDecoder <binary log> [text output], the text goes to stdout when no output file is given
+int main(const int argc, char* argv[]) {
+    if (argc<2||argc>3) {
+        fprintf(stderr, "Usage: %s <binary log> [text output]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* in=fopen(argv[1], "rb");
+    if (in==nullptr) {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    FILE* out=argc==3?fopen(argv[2], "w"):stdout;
+    if (out==nullptr) {
+        fprintf(stderr, "Failed to open %s\n", argv[2]);
+        fclose(in);
+        return 1;
+    }
+
+    const bool decoded=MyLogger::DecodeBinary(in, out);
+    if (!decoded) fprintf(stderr, "%s is not a complete binary log\n", argv[1]);
+    fclose(in);
+    if (out!=stdout) fclose(out);
+    return decoded?0:1;
+}
@@ -0,0 +1,107 @@
+// 连接接受吞吐量：多个客户端线程反复连接并立即断开，统计服务端每秒接受的连接数
+// 用法：AcceptBenchmark [auto|iocp|epoll|uring] [接受者数] [客户端线程数] [秒数]
+// 接受者数大于1时使用SO_REUSEPORT分片监听
+
+#include "MySocketX.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr unsigned PORT=39100;
+
+    std::atomic<unsigned long long> accepted{0};
+
+    class AcceptServer : public MySocketX {
+        public:
+            using MySocketX::MySocketX;
+
+            void OnConnect(SOCKET, void*) override {
+                accepted.fetch_add(1, std::memory_order_relaxed);
+            }
+    };
+
+    EventLoopType ParseLoop(const char* name) {
+        if (strcmp(name, "iocp")==0) return EventLoopType::IOCP;
+        if (strcmp(name, "epoll")==0) return EventLoopType::Epoll;
+        if (strcmp(name, "uring")==0) return EventLoopType::IoUring;
+        return EventLoopType::Auto;
+    }
+
+    // 连接后以RST关闭，客户端端口不会堆积在TIME_WAIT
+    bool ConnectOnce() {
+        const SOCKET sock=socket(AF_INET, SOCK_STREAM, 0);
+        if (sock==INVALID_SOCKET) return false;
+
+        SOCKADDR_IN addr{};
+        addr.sin_family=AF_INET;
+        addr.sin_port=htons(PORT);
+        addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+        const bool ok=connect(sock, reinterpret_cast<SOCKADDR*>(&addr), sizeof(addr))!=SOCKET_ERROR;
+
+        linger abort{};
+        abort.l_onoff=1;
+        abort.l_linger=0;
+        setsockopt(sock, SOL_SOCKET, SO_LINGER, reinterpret_cast<const char*>(&abort), sizeof(abort));
+        closesocket(sock);
+        return ok;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* loopName=argc>1?argv[1]:"auto";
+    const ui acceptors=argc>2?static_cast<ui>(atoi(argv[2])):1;
+    const int clients=argc>3?atoi(argv[3]):4;
+    const int seconds=argc>4?atoi(argv[4]):3;
+
+    MyLogger::SetLevel(LogLevel::Fatal); // 每个连接的日志会掩盖接受路径本身的开销
+    AcceptServer server;
+    MySocketX::Initialize();
+    MySocketX::SetEventLoop(ParseLoop(loopName));
+    MySocketX::SetAcceptors(acceptors, acceptors>1);
+    if (!MySocketX::Create(ProtocolType::TCP, "127.0.0.1", PORT, SocketType::server)) {
+        fprintf(stderr, "Creating the server failed\n");
+        return 1;
+    }
+    std::thread serverThread([&server] {server.Start();});
+
+    // 等待开始监听，预热连接不计入结果
+    while (!ConnectOnce())
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    accepted.store(0);
+
+    std::atomic<unsigned long long> connected{0};
+    std::atomic<unsigned long long> failed{0};
+    const auto start=std::chrono::steady_clock::now();
+    const auto deadline=start+std::chrono::seconds(seconds);
+    std::vector<std::thread> threads;
+    for (int i=0;i<clients;++i) {
+        threads.emplace_back([&] {
+            unsigned long long ok=0, error=0;
+            while (std::chrono::steady_clock::now()<deadline) {
+                if (ConnectOnce()) ++ok;
+                else ++error;
+            }
+            connected.fetch_add(ok);
+            failed.fetch_add(error);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    const double elapsed=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // 等待已完成握手的连接被接受
+
+    printf("%s, %u acceptors, %d clients: %llu connected, %llu failed, %llu accepted, %.0f accepts/s\n",
+        loopName, acceptors, clients, connected.load(), failed.load(), accepted.load(),
+        static_cast<double>(accepted.load())/elapsed);
+
+    MySocketX::Close();
+    serverThread.join();
+    return 0;
+}
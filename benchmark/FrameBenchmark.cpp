@@ -0,0 +1,99 @@
+// 分帧解析吞吐量：把连续排列的帧按固定读取大小切块送入FrameDecoder
+// 与原先的做法对比：每次接收追加到字符串，拷贝出完整帧后从头部erase
+// 用法：FrameBenchmark [总字节数MiB]
+
+#include "FrameDecoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+    // 生成total字节左右的帧流，sizeOf(i)给出第i帧的负载长度
+    template<class F>
+    std::string MakeStream(const size_t total, F&& sizeOf) {
+        std::string stream;
+        stream.reserve(total+4096);
+        for (size_t i=0;stream.size()<total;++i) {
+            const uint32_t len=sizeOf(i);
+            const unsigned char prefix[4]={static_cast<unsigned char>(len>>24), static_cast<unsigned char>(len>>16),
+                static_cast<unsigned char>(len>>8), static_cast<unsigned char>(len)};
+            stream.append(reinterpret_cast<const char*>(prefix), 4);
+            stream.append(len, 'x');
+        }
+        return stream;
+    }
+
+    uint32_t ReadLength(const char* p) {
+        const auto bytes=reinterpret_cast<const unsigned char*>(p);
+        return static_cast<uint32_t>(bytes[0])<<24|static_cast<uint32_t>(bytes[1])<<16|
+            static_cast<uint32_t>(bytes[2])<<8|static_cast<uint32_t>(bytes[3]);
+    }
+
+    // 原先的累积字符串做法
+    size_t RunString(const std::string& stream, const size_t readSize, size_t& checksum) {
+        std::string accumulated;
+        size_t frames=0;
+        for (size_t offset=0;offset<stream.size();offset+=readSize) {
+            accumulated.append(stream, offset, readSize);
+            while (accumulated.size()>=4) {
+                const uint32_t len=ReadLength(accumulated.data());
+                if (accumulated.size()-4<len) break;
+                const std::string message=accumulated.substr(4, len);
+                checksum+=message.size();
+                accumulated.erase(0, 4+static_cast<size_t>(len));
+                ++frames;
+            }
+        }
+        return frames;
+    }
+
+    size_t RunDecoder(const std::string& stream, const size_t readSize, size_t& checksum) {
+        FrameDecoder decoder;
+        size_t frames=0;
+        for (size_t offset=0;offset<stream.size();offset+=readSize) {
+            const size_t len=std::min(readSize, stream.size()-offset);
+            decoder.Feed(stream.data()+offset, len, [&](const char*, const uint32_t length) {
+                checksum+=length;
+                ++frames;
+            });
+        }
+        return frames;
+    }
+
+    template<class F>
+    void Measure(const char* name, const std::string& stream, const size_t readSize, F&& run) {
+        size_t checksum=0;
+        const auto start=std::chrono::steady_clock::now();
+        const size_t frames=run(stream, readSize, checksum);
+        const double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        printf("  %-8s read %6zu: %8.1f MiB/s %10.0f frames/s (checksum %zu)\n", name, readSize,
+            static_cast<double>(stream.size())/seconds/(1<<20), static_cast<double>(frames)/seconds, checksum);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t total=(argc>1?static_cast<size_t>(atoi(argv[1])):64)<<20;
+
+    struct Workload {
+        const char* name;
+        std::string stream;
+    };
+    std::vector<Workload> workloads;
+    workloads.push_back({"16 B frames", MakeStream(total, [](size_t) {return 16u;})});
+    workloads.push_back({"256 B frames", MakeStream(total, [](size_t) {return 256u;})});
+    workloads.push_back({"4 KiB frames", MakeStream(total, [](size_t) {return 4096u;})});
+    workloads.push_back({"mixed 1..3000 B frames", MakeStream(total, [](const size_t i) {return static_cast<uint32_t>(1+i*37%3000);})});
+
+    // 1 KiB为一次接收的缓冲区大小，64 KiB模拟一次读到大量流水线帧
+    for (const auto& workload : workloads) {
+        printf("%s\n", workload.name);
+        for (const size_t readSize : {static_cast<size_t>(1024), static_cast<size_t>(64*1024)}) {
+            Measure("decoder", workload.stream, readSize, RunDecoder);
+            Measure("string", workload.stream, readSize, RunString);
+        }
+    }
+    return 0;
+}
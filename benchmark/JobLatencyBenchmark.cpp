@@ -0,0 +1,94 @@
+// 线程池调度延迟：统计从PushJob返回前的时刻到任务开始执行的p50/p99
+// paced模式按固定间隔提交，线程在两次提交之间休眠，测量唤醒路径；burst模式一次提交全部任务，测量排队路径
+// 另外对比AdaptiveMutex与std::mutex在多线程争用下每次加解锁的耗时
+// 用法：JobLatencyBenchmark [线程数] [任务数]
+
+#include "AdaptiveMutex.h"
+#include "MyThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock=std::chrono::steady_clock;
+
+    struct Job {
+        Clock::time_point pushed;
+        double* latency; // 开始执行时写入的延迟（微秒）
+        std::atomic<size_t>* done;
+    };
+
+    void RunJob(void* data) {
+        const auto job=static_cast<Job*>(data);
+        *job->latency=std::chrono::duration<double, std::micro>(Clock::now()-job->pushed).count();
+        job->done->fetch_add(1, std::memory_order_release);
+    }
+
+    double Percentile(std::vector<double>& samples, const double p) {
+        const size_t index=std::min(samples.size()-1, static_cast<size_t>(p*static_cast<double>(samples.size())));
+        std::nth_element(samples.begin(), samples.begin()+static_cast<std::ptrdiff_t>(index), samples.end());
+        return samples[index];
+    }
+
+    void MeasureJobs(const char* name, const ui threads, const size_t count, const std::chrono::microseconds interval) {
+        MyThreadPool pool(threads);
+        std::vector<double> latency(count);
+        std::vector<Job> jobs(count);
+        std::atomic<size_t> done{0};
+
+        for (size_t i=0;i<count;++i) {
+            jobs[i].latency=&latency[i];
+            jobs[i].done=&done;
+            if (interval.count()>0) std::this_thread::sleep_for(interval);
+            jobs[i].pushed=Clock::now();
+            pool.PushJob(RunJob, &jobs[i]);
+        }
+        while (done.load(std::memory_order_acquire)<count)
+            std::this_thread::yield();
+        pool.StopAll();
+
+        printf("%-6s %zu jobs: p50 %8.2f us, p99 %8.2f us, max %8.2f us\n", name, count,
+            Percentile(latency, 0.5), Percentile(latency, 0.99), *std::max_element(latency.begin(), latency.end()));
+    }
+
+    template<class Mutex>
+    void MeasureLock(const char* name, const unsigned threads, const unsigned iterations) {
+        Mutex mutex;
+        unsigned long long counter=0;
+        std::vector<std::thread> workers;
+        const auto start=Clock::now();
+        for (unsigned t=0;t<threads;++t) {
+            workers.emplace_back([&] {
+                for (unsigned i=0;i<iterations;++i) {
+                    std::lock_guard lock(mutex);
+                    ++counter;
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        const double nanos=std::chrono::duration<double, std::nano>(Clock::now()-start).count();
+        printf("%-13s %2u threads: %7.1f ns per lock/unlock (counter %llu)\n", name, threads,
+            nanos/(static_cast<double>(threads)*iterations), counter);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const ui threads=argc>1?static_cast<ui>(atoi(argv[1])):4;
+    const size_t count=argc>2?static_cast<size_t>(atoi(argv[2])):20000;
+
+    MeasureJobs("paced", threads, count, std::chrono::microseconds(50));
+    MeasureJobs("burst", threads, count, std::chrono::microseconds(0));
+
+    for (const unsigned lockThreads : {1u, 2u, 4u, 8u}) {
+        MeasureLock<AdaptiveMutex>("AdaptiveMutex", lockThreads, 1000000);
+        MeasureLock<std::mutex>("std::mutex", lockThreads, 1000000);
+    }
+    return 0;
+}
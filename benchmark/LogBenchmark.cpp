@@ -0,0 +1,75 @@
+// Logger throughput: producer threads log formatted lines as fast as they can
+// Reports sustained lines per second, including the final flush, and the p50/p99 cost of one MYLOG_INFO call
+// batchSize=1 with flushBytes=1 writes after taking at most one line per producer, close to one write per line;
+// the default batches up to 64 KiB per write
+// Text lines are echoed to stdout, so run it as: LogBenchmark [threads] [lines per thread] >/dev/null
+// Results go to stderr
+
+#include "MyLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock=std::chrono::steady_clock;
+
+    const char* const LOG_FILE="LogBenchmark.log";
+
+    double Percentile(std::vector<double>& samples, const double p) {
+        const size_t index=std::min(samples.size()-1, static_cast<size_t>(p*static_cast<double>(samples.size())));
+        std::nth_element(samples.begin(), samples.begin()+static_cast<std::ptrdiff_t>(index), samples.end());
+        return samples[index];
+    }
+
+    void Measure(const char* name, const LoggerConfig& config, const unsigned threads, const unsigned lines) {
+        std::vector<std::vector<double>> latencies(threads);
+        MyLogger::SetFilename(LOG_FILE);
+        auto logger=MyLogger::Create(false, config);
+
+        const auto start=Clock::now();
+        std::vector<std::thread> producers;
+        for (unsigned t=0;t<threads;++t) {
+            producers.emplace_back([&latencies, t, lines] {
+                std::vector<double>& samples=latencies[t];
+                samples.reserve(lines);
+                for (unsigned i=0;i<lines;++i) {
+                    const auto before=Clock::now();
+                    MYLOG_INFO("producer {} line {} value {}", t, i, i*0.5);
+                    samples.push_back(std::chrono::duration<double, std::nano>(Clock::now()-before).count());
+                }
+            });
+        }
+        for (auto& producer : producers)
+            producer.join();
+        logger.reset(); // Stops the writer once everything staged has been written
+        const double seconds=std::chrono::duration<double>(Clock::now()-start).count();
+
+        std::vector<double> all;
+        for (const auto& samples : latencies)
+            all.insert(all.end(), samples.begin(), samples.end());
+        fprintf(stderr, "%-16s %u threads: %9.0f lines/s, call p50 %6.0f ns, p99 %7.0f ns, dropped %llu\n", name, threads,
+            static_cast<double>(threads)*lines/seconds, Percentile(all, 0.5), Percentile(all, 0.99), MyLogger::DroppedCount());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned threads=argc>1?static_cast<unsigned>(atoi(argv[1])):4;
+    const unsigned lines=argc>2?static_cast<unsigned>(atoi(argv[2])):200000;
+
+    LoggerConfig perLine;
+    perLine.batchSize=1;
+    perLine.flushBytes=1;
+    Measure("text, per line", perLine, threads, lines);
+    Measure("text, batched", LoggerConfig(), threads, lines);
+
+    LoggerConfig binary;
+    binary.binary=true;
+    Measure("binary, batched", binary, threads, lines);
+
+    remove(LOG_FILE);
+    return 0;
+}
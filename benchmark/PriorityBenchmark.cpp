@@ -0,0 +1,79 @@
+// 优先级通道：background队列保持饱和时，统计高优先级任务从提交到开始执行的p50/p99
+// 同一组探测任务分别以Realtime和Background提交，后者即没有优先级时排在积压之后的情况
+// 用法：PriorityBenchmark [线程数] [探测任务数] [每个后台任务的微秒数]
+
+#include "MyThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock=std::chrono::steady_clock;
+
+    constexpr long BACKLOG=2000; // 后台队列中保持的任务数
+
+    double Percentile(std::vector<double>& samples, const double p) {
+        const size_t index=std::min(samples.size()-1, static_cast<size_t>(p*static_cast<double>(samples.size())));
+        std::nth_element(samples.begin(), samples.begin()+static_cast<std::ptrdiff_t>(index), samples.end());
+        return samples[index];
+    }
+
+    void Measure(const Priority probePriority, const char* name, const ui threads, const size_t probes,
+        const std::chrono::microseconds work) {
+        MyThreadPool pool(threads);
+        std::atomic<long> queued{0};
+        std::atomic<bool> stop{false};
+        std::atomic<unsigned long long> background{0};
+
+        // 后台任务忙等work后结束，补充线程使积压始终保持在BACKLOG左右
+        std::thread feeder([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (queued.load(std::memory_order_relaxed)>=BACKLOG) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                queued.fetch_add(1, std::memory_order_relaxed);
+                pool.Post([&queued, &background, work] {
+                    const auto start=Clock::now();
+                    while (Clock::now()-start<work) {}
+                    background.fetch_add(1, std::memory_order_relaxed);
+                    queued.fetch_sub(1, std::memory_order_relaxed);
+                }, Priority::Background);
+            }
+        });
+        while (queued.load()<BACKLOG)
+            std::this_thread::yield();
+
+        std::vector<double> latency;
+        latency.reserve(probes);
+        for (size_t i=0;i<probes;++i) {
+            const auto pushed=Clock::now();
+            auto future=pool.Submit(probePriority, [pushed] {
+                return std::chrono::duration<double, std::micro>(Clock::now()-pushed).count();
+            });
+            latency.push_back(future.Get());
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+
+        stop.store(true);
+        feeder.join();
+        pool.StopAll();
+        printf("%-10s probes: p50 %10.1f us, p99 %10.1f us (%llu background jobs ran)\n", name,
+            Percentile(latency, 0.5), Percentile(latency, 0.99), background.load());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const ui threads=argc>1?static_cast<ui>(atoi(argv[1])):4;
+    const size_t probes=argc>2?static_cast<size_t>(atoi(argv[2])):500;
+    const std::chrono::microseconds work(argc>3?atoi(argv[3]):20);
+
+    Measure(Priority::Realtime, "realtime", threads, probes, work);
+    Measure(Priority::Background, "background", threads, probes, work);
+    return 0;
+}
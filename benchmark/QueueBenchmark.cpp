@@ -0,0 +1,96 @@
+// 队列吞吐量：不同生产者/消费者数下每秒传递的元素数
+// 对比加锁的Queue（Push/PopWait）、BoundedQueue的Mpmc和Spsc模式（Push/Pop）
+// 用法：QueueBenchmark [每组元素数] [有界队列容量]
+
+#include "BoundedQueue.h"
+#include "Queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr uint64_t STOP=UINT64_MAX; // 每个消费者收到一个后退出
+
+    // 统一两种队列的阻塞接口
+    struct LockedQueue {
+        explicit LockedQueue(size_t) {}
+        void Push(const uint64_t value) {queue.Push(value);}
+        void Pop(uint64_t& value) {
+            if (!queue.PopWait(value)) value=STOP;
+        }
+        Queue<uint64_t> queue;
+    };
+
+    template<QueueMode Mode>
+    struct RingQueue {
+        explicit RingQueue(const size_t capacity):queue(capacity) {}
+        void Push(const uint64_t value) {queue.Push(value);}
+        void Pop(uint64_t& value) {queue.Pop(value);}
+        BoundedQueue<uint64_t, Mode> queue;
+    };
+
+    template<class Q>
+    void Measure(const char* name, const unsigned producers, const unsigned consumers, const uint64_t items,
+        const size_t capacity) {
+        Q queue(capacity);
+        std::atomic<uint64_t> sum{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+
+        for (unsigned c=0;c<consumers;++c) {
+            threads.emplace_back([&] {
+                uint64_t local=0, value;
+                while (true) {
+                    queue.Pop(value);
+                    if (value==STOP) break;
+                    local+=value;
+                }
+                sum.fetch_add(local);
+            });
+        }
+
+        std::vector<std::thread> producerThreads;
+        for (unsigned p=0;p<producers;++p) {
+            producerThreads.emplace_back([&, p] {
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                for (uint64_t i=p;i<items;i+=producers)
+                    queue.Push(i);
+            });
+        }
+
+        const auto start=std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& thread : producerThreads)
+            thread.join();
+        for (unsigned c=0;c<consumers;++c)
+            queue.Push(STOP);
+        for (auto& thread : threads)
+            thread.join();
+        const double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+        const bool ok=sum.load()==items*(items-1)/2;
+        printf("%-12s %u producers / %u consumers: %7.2f M items/s%s\n", name, producers, consumers,
+            static_cast<double>(items)/seconds/1e6, ok?"":" (checksum mismatch)");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const uint64_t items=argc>1?static_cast<uint64_t>(atoll(argv[1])):2000000;
+    const size_t capacity=argc>2?static_cast<size_t>(atoll(argv[2])):4096;
+
+    Measure<LockedQueue>("Queue", 1, 1, items, capacity);
+    Measure<RingQueue<QueueMode::Mpmc>>("BoundedMpmc", 1, 1, items, capacity);
+    Measure<RingQueue<QueueMode::Spsc>>("BoundedSpsc", 1, 1, items, capacity);
+
+    const unsigned shapes[][2]={{2, 2}, {4, 4}, {4, 1}, {1, 4}, {8, 8}};
+    for (const auto& shape : shapes) {
+        Measure<LockedQueue>("Queue", shape[0], shape[1], items, capacity);
+        Measure<RingQueue<QueueMode::Mpmc>>("BoundedMpmc", shape[0], shape[1], items, capacity);
+    }
+    return 0;
+}
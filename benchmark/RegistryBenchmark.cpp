@@ -0,0 +1,155 @@
+// 连接表争用：多个线程并发执行发送查找、套接字到ID的查找和连接/断开
+// 对比按64个分片加读写锁的ShardedMap、单个读写锁（1个分片）和原先单个互斥锁保护的unordered_map
+// 用法：RegistryBenchmark [最大线程数] [每线程操作数]
+
+#include "ShardedMap.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr unsigned CLIENTS=10000;
+
+    struct ClientInfo {
+        int socket;
+        void* handleData;
+        void* extraData;
+    };
+
+    // 原先的做法：两个表由同一个锁保护
+    class LockedRegistry {
+        public:
+            void Insert(const unsigned id, const ClientInfo& info) {
+                std::lock_guard lock(mutex);
+                clients[id]=info;
+                sockets[info.socket]=id;
+            }
+
+            void Erase(const unsigned id) {
+                std::lock_guard lock(mutex);
+                auto it=clients.find(id);
+                if (it==clients.end()) return;
+                sockets.erase(it->second.socket);
+                clients.erase(it);
+            }
+
+            template<class F>
+            bool Visit(const unsigned id, F&& f) {
+                std::lock_guard lock(mutex);
+                auto it=clients.find(id);
+                if (it==clients.end()) return false;
+                f(it->second);
+                return true;
+            }
+
+            bool FindId(const int socket, unsigned& id) {
+                std::lock_guard lock(mutex);
+                auto it=sockets.find(socket);
+                if (it==sockets.end()) return false;
+                id=it->second;
+                return true;
+            }
+
+        private:
+            std::mutex mutex;
+            std::unordered_map<unsigned, ClientInfo> clients;
+            std::unordered_map<int, unsigned> sockets;
+    };
+
+    // 与MySocketXImpl相同的两个分片表
+    template<unsigned Shards>
+    class ShardedRegistry {
+        public:
+            void Insert(const unsigned id, const ClientInfo& info) {
+                clients.Insert(id, info);
+                sockets.Insert(info.socket, id);
+            }
+
+            void Erase(const unsigned id) {
+                ClientInfo info{};
+                if (clients.Erase(id, &info)) sockets.Erase(info.socket);
+            }
+
+            template<class F>
+            bool Visit(const unsigned id, F&& f) {return clients.Visit(id, std::forward<F>(f));}
+
+            bool FindId(const int socket, unsigned& id) {return sockets.Find(socket, id);}
+
+        private:
+            ShardedMap<unsigned, ClientInfo, Shards> clients;
+            ShardedMap<int, unsigned, Shards> sockets;
+    };
+
+    // 每个线程按90%发送查找、5%套接字查找、5%断开后重新连接的比例操作
+    template<class Registry>
+    double Run(const unsigned threads, const unsigned ops) {
+        Registry registry;
+        std::atomic<unsigned> nextId{0};
+        for (unsigned i=0;i<CLIENTS;++i) {
+            const unsigned id=nextId++;
+            registry.Insert(id, {static_cast<int>(id), nullptr, nullptr});
+        }
+
+        std::atomic<unsigned> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<unsigned long long> found{0};
+        std::vector<std::thread> workers;
+        for (unsigned t=0;t<threads;++t) {
+            workers.emplace_back([&, t] {
+                uint64_t seed=0x9E3779B97F4A7C15ull*(t+1);
+                unsigned long long hits=0;
+                ++ready;
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+                for (unsigned i=0;i<ops;++i) {
+                    seed^=seed<<13;
+                    seed^=seed>>7;
+                    seed^=seed<<17;
+                    const unsigned id=static_cast<unsigned>(seed>>32)%nextId.load(std::memory_order_relaxed);
+                    const unsigned kind=static_cast<unsigned>(seed%100);
+                    if (kind<90) {
+                        hits+=registry.Visit(id, [](ClientInfo& info) {info.extraData=&info;});
+                    }
+                    else if (kind<95) {
+                        unsigned owner;
+                        hits+=registry.FindId(static_cast<int>(id), owner);
+                    }
+                    else {
+                        registry.Erase(id);
+                        const unsigned newId=nextId++;
+                        registry.Insert(newId, {static_cast<int>(newId), nullptr, nullptr});
+                    }
+                }
+                found+=hits;
+            });
+        }
+
+        while (ready.load()<threads) std::this_thread::yield();
+        const auto start=std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers)
+            worker.join();
+        const double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        return static_cast<double>(threads)*ops/seconds/1e6;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned maxThreads=argc>1?static_cast<unsigned>(atoi(argv[1])):64;
+    const unsigned ops=argc>2?static_cast<unsigned>(atoi(argv[2])):200000;
+
+    printf("threads  sharded(64)  shared_mutex(1)  mutex   (Mops/s)\n");
+    for (unsigned threads=1;threads<=maxThreads;threads*=2) {
+        const double sharded=Run<ShardedRegistry<64>>(threads, ops);
+        const double single=Run<ShardedRegistry<1>>(threads, ops);
+        const double locked=Run<LockedRegistry>(threads, ops);
+        printf("%7u  %11.2f  %15.2f  %6.2f\n", threads, sharded, single, locked);
+    }
+    return 0;
+}
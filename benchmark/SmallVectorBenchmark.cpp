@@ -0,0 +1,72 @@
+// SmallVector的分配节省：反复创建短小的列表、追加元素、遍历后销毁
+// 统计每个列表的堆分配次数和耗时，对比SmallVector<T, 8>、Vector<T>和std::vector<T>
+// 用法：SmallVectorBenchmark [轮数]
+
+#include "SmallVector.h"
+#include "Vector.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+    std::atomic<unsigned long long> allocations{0};
+}
+
+// 统计进程内所有的堆分配
+void* operator new(const size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p=malloc(size==0?1:size)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {free(p);}
+void operator delete(void* p, size_t) noexcept {free(p);}
+
+namespace {
+    template<class T>
+    T MakeValue(const ui i) {
+        if constexpr (std::is_same_v<T, std::string>) return std::string(8, static_cast<char>('a'+i%26)); // 短字符串不申请内存
+        else return static_cast<T>(i);
+    }
+
+    template<class T, class Container, class Append>
+    void Measure(const char* name, const ui elements, const ui rounds, Append&& append) {
+        size_t checksum=0;
+        const unsigned long long before=allocations.load();
+        const auto start=std::chrono::steady_clock::now();
+        for (ui r=0;r<rounds;++r) {
+            Container list;
+            for (ui i=0;i<elements;++i)
+                append(list, MakeValue<T>(i+r));
+            for (const auto& value : list) {
+                if constexpr (std::is_same_v<T, std::string>) checksum+=value.size();
+                else checksum+=static_cast<size_t>(value);
+            }
+        }
+        const double nanos=std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count();
+        printf("  %-22s %2u elements: %7.1f ns, %5.2f allocations per list (checksum %zu)\n", name, elements,
+            nanos/rounds, static_cast<double>(allocations.load()-before)/rounds, checksum);
+    }
+
+    template<class T>
+    void MeasureType(const char* type, const ui rounds) {
+        printf("%s\n", type);
+        for (const ui elements : {2u, 8u, 32u}) {
+            Measure<T, SmallVector<T, 8>>("SmallVector<T, 8>", elements, rounds, [](auto& list, T value) {list.PushBack(std::move(value));});
+            Measure<T, Vector<T>>("Vector<T>", elements, rounds, [](auto& list, T value) {list.PushBack(std::move(value));});
+            Measure<T, std::vector<T>>("std::vector<T>", elements, rounds, [](auto& list, T value) {list.push_back(std::move(value));});
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const ui rounds=argc>1?static_cast<ui>(atoi(argv[1])):1000000;
+
+    MeasureType<int>("int", rounds);
+    MeasureType<std::string>("std::string", rounds);
+    return 0;
+}
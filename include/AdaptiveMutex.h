@@ -0,0 +1,74 @@
+#ifndef ADAPTIVEMUTEX_H
+#define ADAPTIVEMUTEX_H
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 在地址上等待/唤醒（Linux为futex，Windows为WaitOnAddress，其他平台退化为让出时间片）
+// FutexWait在*address!=expected时立即返回，也可能被虚假唤醒，调用方需循环检查条件
+// timeoutMicros小于0时一直等待
+void FutexWait(std::atomic<uint32_t>* address, uint32_t expected, long long timeoutMicros=-1);
+void FutexWake(std::atomic<uint32_t>* address, bool all=false);
+
+// 自适应互斥锁：先短暂自旋，仍未获得时在futex上休眠
+// 无竞争时加解锁各一次原子操作，解锁只在有等待者时进入内核
+// 接口与std::mutex相同，可配合std::lock_guard/std::unique_lock使用
+class AdaptiveMutex {
+    public:
+        AdaptiveMutex()=default;
+        AdaptiveMutex(const AdaptiveMutex&)=delete;
+        AdaptiveMutex& operator=(const AdaptiveMutex&)=delete;
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+    private:
+        static constexpr int SPIN_COUNT=128; // 休眠前的自旋次数
+        enum : uint32_t {UNLOCKED=0, LOCKED=1, CONTENDED=2};
+
+        static void CpuRelax();
+
+    private:
+        std::atomic<uint32_t> state{UNLOCKED};
+};
+
+inline bool AdaptiveMutex::try_lock() {
+    uint32_t expected=UNLOCKED;
+    return state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline void AdaptiveMutex::lock() {
+    if (try_lock()) return;
+
+    // 锁通常很快释放，先自旋等待，只读不写避免抢占缓存行
+    for (int spin=0;spin<SPIN_COUNT;++spin) {
+        CpuRelax();
+        if (state.load(std::memory_order_relaxed)==UNLOCKED&&try_lock()) return;
+    }
+
+    // 标记为有等待者后休眠，被唤醒时仍以CONTENDED获取，保证解锁时会唤醒其他等待者
+    while (state.exchange(CONTENDED, std::memory_order_acquire)!=UNLOCKED)
+        FutexWait(&state, CONTENDED);
+}
+
+inline void AdaptiveMutex::unlock() {
+    if (state.exchange(UNLOCKED, std::memory_order_release)==CONTENDED)
+        FutexWake(&state);
+}
+
+inline void AdaptiveMutex::CpuRelax() {
+#if defined(__x86_64__)||defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(_M_X64)||defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+#endif //ADAPTIVEMUTEX_H
@@ -0,0 +1,244 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+enum class QueueMode {
+    Mpmc, // 多生产者多消费者
+    Spsc // 单生产者单消费者
+};
+
+// 有界无锁环形队列，容量向上取整为2的幂
+// 元素构造在未初始化的槽位中，不要求T可默认构造；出队直接移动到输出参数，不存在Front()与Pop()之间的竞争
+// Mpmc为Vyukov算法，每个槽位用序号区分可写和可读；Spsc特化只用一对读写下标，并缓存对方的下标减少缓存行往返
+template<class T, QueueMode Mode=QueueMode::Mpmc>
+class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity);
+        ~BoundedQueue();
+        BoundedQueue(const BoundedQueue&)=delete;
+        BoundedQueue& operator=(const BoundedQueue&)=delete;
+
+        template<class... Args>
+        bool TryEmplace(Args&&... args); // 队列已满时返回false
+        bool TryPush(const T& value) {return TryEmplace(value);}
+        bool TryPush(T&& value) {return TryEmplace(std::move(value));} // 失败时不移动value
+        bool TryPop(T& value); // 队列为空时返回false
+        void Push(T value); // 队列已满时等待
+        void Pop(T& value); // 队列为空时等待
+
+        [[nodiscard]] bool Empty()const {return Size()==0;} // 并发读写时为近似值
+        [[nodiscard]] size_t Size()const;
+        [[nodiscard]] size_t Capacity()const {return mask+1;}
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T* Value() {return std::launder(reinterpret_cast<T*>(storage));}
+        };
+
+    private:
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+        alignas(64) std::atomic<size_t> enqueuePos{0};
+        alignas(64) std::atomic<size_t> dequeuePos{0};
+};
+
+template<class T>
+class BoundedQueue<T, QueueMode::Spsc> {
+    public:
+        explicit BoundedQueue(size_t capacity);
+        ~BoundedQueue();
+        BoundedQueue(const BoundedQueue&)=delete;
+        BoundedQueue& operator=(const BoundedQueue&)=delete;
+
+        template<class... Args>
+        bool TryEmplace(Args&&... args); // 只能由生产者调用
+        bool TryPush(const T& value) {return TryEmplace(value);}
+        bool TryPush(T&& value) {return TryEmplace(std::move(value));}
+        bool TryPop(T& value); // 只能由消费者调用
+        void Push(T value);
+        void Pop(T& value);
+
+        [[nodiscard]] bool Empty()const {return Size()==0;}
+        [[nodiscard]] size_t Size()const;
+        [[nodiscard]] size_t Capacity()const {return mask+1;}
+
+    private:
+        struct Slot {
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T* Value() {return std::launder(reinterpret_cast<T*>(storage));}
+        };
+
+    private:
+        std::unique_ptr<Slot[]> slots;
+        size_t mask;
+        alignas(64) std::atomic<size_t> tail{0}; // 生产者写入
+        size_t cachedHead=0; // 生产者看到的消费位置
+        alignas(64) std::atomic<size_t> head{0}; // 消费者写入
+        size_t cachedTail=0; // 消费者看到的生产位置
+};
+
+namespace BoundedQueueDetail {
+    inline size_t RoundCapacity(size_t capacity) {
+        size_t rounded=2;
+        while (rounded<capacity) rounded<<=1;
+        return rounded;
+    }
+
+    // 等待对方线程时先自旋，再让出时间片
+    inline void Backoff(unsigned& spins) {
+        if (++spins>64) std::this_thread::yield();
+    }
+}
+
+template<class T, QueueMode Mode>
+BoundedQueue<T, Mode>::BoundedQueue(const size_t capacity):mask(BoundedQueueDetail::RoundCapacity(capacity)-1) {
+    cells=std::make_unique<Cell[]>(mask+1);
+    for (size_t i=0;i<=mask;++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template<class T, QueueMode Mode>
+BoundedQueue<T, Mode>::~BoundedQueue() {
+    const size_t last=enqueuePos.load(std::memory_order_relaxed);
+    for (size_t pos=dequeuePos.load(std::memory_order_relaxed);pos!=last;++pos)
+        cells[pos&mask].Value()->~T();
+}
+
+template<class T, QueueMode Mode>
+template<class... Args>
+bool BoundedQueue<T, Mode>::TryEmplace(Args&&... args) {
+    size_t pos=enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell=&cells[pos&mask];
+        const size_t sequence=cell->sequence.load(std::memory_order_acquire);
+        const auto diff=static_cast<intptr_t>(sequence)-static_cast<intptr_t>(pos);
+        if (diff==0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) break;
+        }
+        else if (diff<0) return false; // 队列已满
+        else pos=enqueuePos.load(std::memory_order_relaxed);
+    }
+
+    ::new(cell->storage) T(std::forward<Args>(args)...);
+    cell->sequence.store(pos+1, std::memory_order_release);
+    return true;
+}
+
+template<class T, QueueMode Mode>
+bool BoundedQueue<T, Mode>::TryPop(T& value) {
+    size_t pos=dequeuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell=&cells[pos&mask];
+        const size_t sequence=cell->sequence.load(std::memory_order_acquire);
+        const auto diff=static_cast<intptr_t>(sequence)-static_cast<intptr_t>(pos+1);
+        if (diff==0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) break;
+        }
+        else if (diff<0) return false; // 队列为空
+        else pos=dequeuePos.load(std::memory_order_relaxed);
+    }
+
+    T* element=cell->Value();
+    value=std::move(*element);
+    element->~T();
+    cell->sequence.store(pos+mask+1, std::memory_order_release);
+    return true;
+}
+
+template<class T, QueueMode Mode>
+void BoundedQueue<T, Mode>::Push(T value) {
+    unsigned spins=0;
+    while (!TryPush(std::move(value)))
+        BoundedQueueDetail::Backoff(spins);
+}
+
+template<class T, QueueMode Mode>
+void BoundedQueue<T, Mode>::Pop(T& value) {
+    unsigned spins=0;
+    while (!TryPop(value))
+        BoundedQueueDetail::Backoff(spins);
+}
+
+template<class T, QueueMode Mode>
+size_t BoundedQueue<T, Mode>::Size()const {
+    const size_t dequeued=dequeuePos.load(std::memory_order_relaxed);
+    const size_t enqueued=enqueuePos.load(std::memory_order_relaxed);
+    return enqueued>dequeued?enqueued-dequeued:0;
+}
+
+template<class T>
+BoundedQueue<T, QueueMode::Spsc>::BoundedQueue(const size_t capacity):mask(BoundedQueueDetail::RoundCapacity(capacity)-1) {
+    slots=std::make_unique<Slot[]>(mask+1);
+}
+
+template<class T>
+BoundedQueue<T, QueueMode::Spsc>::~BoundedQueue() {
+    const size_t last=tail.load(std::memory_order_relaxed);
+    for (size_t pos=head.load(std::memory_order_relaxed);pos!=last;++pos)
+        slots[pos&mask].Value()->~T();
+}
+
+template<class T>
+template<class... Args>
+bool BoundedQueue<T, QueueMode::Spsc>::TryEmplace(Args&&... args) {
+    const size_t pos=tail.load(std::memory_order_relaxed);
+    if (pos-cachedHead>mask) {
+        cachedHead=head.load(std::memory_order_acquire);
+        if (pos-cachedHead>mask) return false; // 队列已满
+    }
+
+    ::new(slots[pos&mask].storage) T(std::forward<Args>(args)...);
+    tail.store(pos+1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+bool BoundedQueue<T, QueueMode::Spsc>::TryPop(T& value) {
+    const size_t pos=head.load(std::memory_order_relaxed);
+    if (pos==cachedTail) {
+        cachedTail=tail.load(std::memory_order_acquire);
+        if (pos==cachedTail) return false; // 队列为空
+    }
+
+    T* element=slots[pos&mask].Value();
+    value=std::move(*element);
+    element->~T();
+    head.store(pos+1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+void BoundedQueue<T, QueueMode::Spsc>::Push(T value) {
+    unsigned spins=0;
+    while (!TryPush(std::move(value)))
+        BoundedQueueDetail::Backoff(spins);
+}
+
+template<class T>
+void BoundedQueue<T, QueueMode::Spsc>::Pop(T& value) {
+    unsigned spins=0;
+    while (!TryPop(value))
+        BoundedQueueDetail::Backoff(spins);
+}
+
+template<class T>
+size_t BoundedQueue<T, QueueMode::Spsc>::Size()const {
+    const size_t popped=head.load(std::memory_order_relaxed);
+    const size_t pushed=tail.load(std::memory_order_relaxed);
+    return pushed>popped?pushed-popped:0;
+}
+
+#endif //BOUNDEDQUEUE_H
@@ -0,0 +1,116 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 4字节大端长度前缀的分帧解析器
+// 完整落在输入数据中的帧直接交给回调，不做拷贝；只有跨越多次接收的帧才拼接到内部缓冲区
+// 缓冲区随实际到达的数据成倍增长，不按长度前缀预先分配，只发送长度前缀的对端占不了多少内存
+class FrameDecoder {
+    public:
+        explicit FrameDecoder(uint32_t maxFrameSize=16u<<20):maxFrameSize(maxFrameSize) {}
+        ~FrameDecoder() {delete[] buffer;}
+        FrameDecoder(const FrameDecoder&)=delete;
+        FrameDecoder& operator=(const FrameDecoder&)=delete;
+
+        // 每个完整帧调用一次onFrame(const char* payload, uint32_t length)，指针只在回调期间有效
+        // 帧长度超过上限时返回false
+        template<class F>
+        bool Feed(const char* data, size_t len, F&& onFrame);
+
+        [[nodiscard]] size_t Pending()const {return size;} // 缓冲区中不完整帧的字节数
+        void Clear();
+
+    private:
+        static uint32_t ReadLength(const char* p);
+        void Append(const char* data, size_t len);
+        void Reserve(size_t len);
+
+    private:
+        static constexpr size_t KEEP_CAPACITY=64*1024; // 超过该大小的缓冲区在帧处理完后释放
+
+        char* buffer=nullptr;
+        size_t size=0;
+        size_t capacity=0;
+        uint32_t maxFrameSize;
+};
+
+template<class F>
+bool FrameDecoder::Feed(const char* data, size_t len, F&& onFrame) {
+    // 先补齐上次残留的不完整帧
+    if (size>0) {
+        if (size<4) {
+            const size_t take=std::min(4-size, len);
+            Append(data, take);
+            data+=take;
+            len-=take;
+            if (size<4) return true;
+        }
+
+        const uint32_t frameSize=ReadLength(buffer);
+        if (frameSize>maxFrameSize) return false;
+
+        const size_t take=std::min(4+static_cast<size_t>(frameSize)-size, len);
+        Append(data, take);
+        data+=take;
+        len-=take;
+        if (size<4+static_cast<size_t>(frameSize)) return true;
+
+        onFrame(static_cast<const char*>(buffer+4), frameSize);
+        size=0;
+        if (capacity>KEEP_CAPACITY) Clear();
+    }
+
+    // 其余完整帧直接在输入数据上解析
+    while (len>=4) {
+        const uint32_t frameSize=ReadLength(data);
+        if (frameSize>maxFrameSize) return false;
+        if (len-4<frameSize) break;
+
+        onFrame(data+4, frameSize);
+        data+=4+static_cast<size_t>(frameSize);
+        len-=4+static_cast<size_t>(frameSize);
+    }
+
+    Append(data, len);
+    return true;
+}
+
+inline void FrameDecoder::Clear() {
+    delete[] buffer;
+    buffer=nullptr;
+    size=capacity=0;
+}
+
+inline uint32_t FrameDecoder::ReadLength(const char* p) {
+    const auto bytes=reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(bytes[0])<<24|static_cast<uint32_t>(bytes[1])<<16|
+        static_cast<uint32_t>(bytes[2])<<8|static_cast<uint32_t>(bytes[3]);
+}
+
+inline void FrameDecoder::Append(const char* data, const size_t len) {
+    if (len==0) return;
+    Reserve(size+len);
+    memcpy(buffer+size, data, len);
+    size+=len;
+}
+
+inline void FrameDecoder::Reserve(const size_t len) {
+    if (len<=capacity) return;
+
+    // 成倍增长，但不超过最大帧所需的大小
+    size_t newCapacity=capacity==0?64:capacity;
+    while (newCapacity<len) newCapacity*=2;
+    newCapacity=std::max(len, std::min(newCapacity, 4+static_cast<size_t>(maxFrameSize)));
+
+    char* newBuffer=new char[newCapacity];
+    if (size>0) memcpy(newBuffer, buffer, size);
+    delete[] buffer;
+    buffer=newBuffer;
+    capacity=newCapacity;
+}
+
+#endif //FRAMEDECODER_H
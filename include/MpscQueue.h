@@ -0,0 +1,66 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// 多生产者单消费者的无锁链表队列（Vyukov）
+// Push可在任意线程调用，Pop只能由一个消费者线程调用
+// 生产者交换头指针后、链接前的短暂窗口内Pop可能看不到该元素，调用方需在Push之后另行唤醒消费者
+template<class T>
+class MpscQueue {
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    public:
+        MpscQueue();
+        ~MpscQueue();
+        MpscQueue(const MpscQueue&)=delete;
+        MpscQueue& operator=(const MpscQueue&)=delete;
+
+        void Push(T value);
+        bool Pop(T& value);
+
+    private:
+        alignas(64) std::atomic<Node*> head; // 生产者端
+        alignas(64) Node* tail; // 消费者端，始终指向一个已取出的占位节点
+};
+
+template<class T>
+MpscQueue<T>::MpscQueue() {
+    Node* stub=new Node{nullptr, T()};
+    head.store(stub, std::memory_order_relaxed);
+    tail=stub;
+}
+
+template<class T>
+MpscQueue<T>::~MpscQueue() {
+    while (tail!=nullptr) {
+        Node* next=tail->next.load(std::memory_order_relaxed);
+        delete tail;
+        tail=next;
+    }
+}
+
+template<class T>
+void MpscQueue<T>::Push(T value) {
+    Node* node=new Node{nullptr, std::move(value)};
+    Node* prev=head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+template<class T>
+bool MpscQueue<T>::Pop(T& value) {
+    Node* next=tail->next.load(std::memory_order_acquire);
+    if (next==nullptr) return false;
+
+    // next成为新的占位节点
+    value=std::move(next->value);
+    delete tail;
+    tail=next;
+    return true;
+}
+
+#endif //MPSCQUEUE_H
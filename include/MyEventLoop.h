@@ -0,0 +1,97 @@
+#ifndef MYEVENTLOOP_H
+#define MYEVENTLOOP_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "MpscQueue.h"
+#include "MySocketX.h"
+#include "Pool.h"
+
+// MySocketX服务端使用的事件循环后端
+// Work线程通过Wait获取接收完成事件，处理后调用Receive继续接收
+// 每个循环记录自己的连接及其分组，广播由各循环的Work线程分别写入各自的连接
+// 非共享循环中连接只由所属Work线程读写，其他线程的发送通过Post投递到该线程执行
+class MyEventLoop {
+    public:
+        struct Event {
+            MySocketX::LPPER_HANDLE_DATA handleData; // 为空表示新连接
+            const char* data; // 接收到的数据，在调用Receive之前有效
+            DWORD bytes; // 本次接收的字节数，0表示对端关闭
+            bool ok;
+            SOCKET socket; // 新连接的套接字
+        };
+
+        virtual ~MyEventLoop()=default;
+
+        // 返回已Open的循环，perThread为true时IOCP也为每个Work线程创建独立的完成端口
+        static std::unique_ptr<MyEventLoop> Create(EventLoopType type, bool perThread=false);
+
+        virtual bool Open()=0; // 创建内核对象
+        virtual bool Shared()const=0; // 是否允许多个Work线程等待同一个循环
+        virtual bool Listen(SOCKET) {return false;} // 由循环接受连接，不支持时Start阻塞accept
+        virtual bool Attach(MySocketX::LPPER_HANDLE_DATA handleData)=0; // 关联新连接并投递接收
+        virtual bool Wait(Event& event)=0; // 等待接收完成事件，循环停止时返回false
+        virtual bool Receive(MySocketX::LPPER_HANDLE_DATA handleData)=0; // 继续接收
+        // 排队发送，积压过多时返回false；shared不为空时data指向其内部，可以只引用不拷贝
+        virtual bool Send(MySocketX::LPPER_HANDLE_DATA handleData, const char* data, size_t len,
+            const SharedPayload* shared=nullptr)=0;
+        // 关闭连接前调用，返回false时发送仍在进行，handleData由后端在发送完成后释放
+        virtual bool Detach(MySocketX::LPPER_HANDLE_DATA handleData)=0;
+        virtual void Stop(ui workers)=0; // 唤醒所有等待的Work线程
+
+        // 在Work线程中执行task，共享循环直接在调用线程执行；循环已关闭时丢弃task并返回false
+        bool Post(std::function<void()> task);
+        void Close() {closed.store(true, std::memory_order_release);} // Stop之前调用，此后不再接受投递
+        [[nodiscard]] bool InLoop()const {return owner.load(std::memory_order_relaxed)==std::this_thread::get_id();}
+
+        // 连接的归属和分组，调用方需保证连接在AddMember和RemoveMember之间有效
+        void AddMember(MySocketX::LPPER_HANDLE_DATA handleData);
+        void RemoveMember(MySocketX::LPPER_HANDLE_DATA handleData);
+        bool Join(MySocketX::LPPER_HANDLE_DATA handleData, const std::string& group);
+        bool Leave(MySocketX::LPPER_HANDLE_DATA handleData, const std::string& group);
+        ui FanOut(const SharedPayload& payload, const std::string& group); // 发送给分组中的连接，group为空时发送给全部连接，返回失败数
+
+        // 每个循环独立的上下文池，连接在所属循环的池中分配和释放
+        Pool<MySocketX::PER_HANDLE_DATA>& getHandlePool() {return handlePool;}
+        Pool<MySocketX::PER_IO_DATA>& getIoPool() {return ioPool;}
+
+    protected:
+        virtual void Wake() {} // 唤醒等待中的Work线程执行投递的任务
+        void RunTasks(); // 由Work线程在Wait中调用
+        void Own() { // 在Wait开始时调用，记录等待该循环的Work线程
+            if (!InLoop()) owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        }
+
+    protected:
+        Pool<MySocketX::PER_HANDLE_DATA> handlePool;
+        Pool<MySocketX::PER_IO_DATA> ioPool;
+
+    private:
+        MpscQueue<std::function<void()>> tasks;
+        std::atomic<bool> wakePending{false}; // 已唤醒但任务尚未执行，避免重复唤醒
+        std::atomic<bool> closed{false};
+        std::atomic<std::thread::id> owner{};
+
+        std::mutex memberLock; // 保护members和groups，Attach可能发生在其他循环的线程
+        std::vector<MySocketX::LPPER_HANDLE_DATA> members;
+        std::unordered_map<std::string, std::unordered_set<MySocketX::LPPER_HANDLE_DATA>> groups;
+};
+
+#ifdef _WIN32
+std::unique_ptr<MyEventLoop> CreateIOCPLoop(bool shared);
+#endif
+
+#ifdef __linux__
+std::unique_ptr<MyEventLoop> CreateEpollLoop();
+std::unique_ptr<MyEventLoop> CreateUringLoop();
+#endif
+
+#endif //MYEVENTLOOP_H
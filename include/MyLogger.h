@@ -1,11 +1,21 @@
 #ifndef MYLOGGER_H
 #define MYLOGGER_H
 
-#include "Queue.h"
-#include "MyThreadPool.h"
-
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <type_traits>
+
+// Levels below this compile to nothing in the MYLOG_* macros (0 Debug, 1 Info, 2 Warning, 3 Error, 4 Fatal)
+#ifndef MYLOGGER_MIN_LEVEL
+#define MYLOGGER_MIN_LEVEL 0
+#endif
 
 enum class LogLevel {
     Debug,
@@ -15,11 +25,34 @@ enum class LogLevel {
     Fatal
 };
 
+// What a producer does when its staging ring is full
+enum class LogOverflow {
+    Block, // Wait for the writer to make room
+    Drop, // Discard the new line and count it
+    Overwrite // Discard the oldest staged line and count it
+};
+
+// Where line timestamps come from
+enum class LogClock {
+    System, // system_clock on every line
+    Monotonic, // steady_clock anchored to system_clock when the writer starts; never jumps
+    Tsc // Calibrated CPU timestamp counter (x86 with an invariant TSC), falls back to Monotonic elsewhere
+};
+
+struct LoggerConfig {
+    size_t flushBytes=64*1024; // Flush once this many bytes are buffered
+    std::chrono::milliseconds flushInterval{50}; // Upper bound on how long a line stays buffered
+    unsigned int batchSize=1024; // Maximum lines taken from each staging ring per pass
+    unsigned int ringCapacity=4096; // Lines each producer thread can stage before the overflow policy applies
+    LogOverflow overflow=LogOverflow::Block;
+    LogClock clock=LogClock::System;
+    bool binary=false; // Stage call-site IDs and encoded arguments instead of text; render the file with MyLogDecoder
+};
+
 class MyLogger {
     public:
         struct Deleter {
             void operator()(MyLogger* ptr) const {
-                fclose(logFile);
                 delete ptr;
             }
         };
@@ -28,25 +61,223 @@ class MyLogger {
         MyLogger& operator=(const MyLogger&)=delete;
 
     public:
-        static std::shared_ptr<MyLogger> Create(bool isDebug=false);
+        static std::shared_ptr<MyLogger> Create(bool isDebug=false, const LoggerConfig& config=LoggerConfig());
+        static std::shared_ptr<MyLogger> Create(const char*, const LoggerConfig& config=LoggerConfig())=delete; // A file name would silently become isDebug, use SetFilename
         static std::string GetLevelString(LogLevel level);
         static int WriteLog(LogLevel level, const std::string& message);
+        template<class... Args>
+        static int Log(LogLevel level, std::string_view format, const Args&... args); // Formats "{}" placeholders straight into the staged line
         static void SetFilename(const std::string& fileName);
+        static unsigned long long DroppedCount(); // Lines lost to the Drop or Overwrite policy
+        static void SetLevel(LogLevel level); // Lines below this level are skipped before any formatting
+        static bool Enabled(const LogLevel level) {return static_cast<int>(level)>=runtimeLevel.load(std::memory_order_relaxed);}
+
+        // Binary mode, used by the MYLOG_* macros while a binary logger is running
+        static bool Binary() {return binaryMode.load(std::memory_order_relaxed);}
+        static uint32_t RegisterSite(LogLevel level, const char* file, unsigned int line, const char* format, std::string_view types); // Returns the call-site ID, never 0
+        template<class... Args>
+        static int LogBinary(uint32_t site, std::string_view format, const Args&... args); // Stages the encoded arguments, the format was registered with the site
+        static bool DecodeBinary(FILE* in, FILE* out); // Renders a binary log file as text, false when it is malformed
 
     private:
-        explicit MyLogger(bool isDebug); // Private constructor to prevent instantiation
-        ~MyLogger()=default; // Private destructor
+        explicit MyLogger(bool isDebug, const LoggerConfig& config); // Private constructor to prevent instantiation
+        ~MyLogger(); // Private destructor, the last logger stops the writer and closes the file
 
-        static std::string CurrentTime();
+        static void AppendTime(std::string& out, long long wallNanos); // Appends "YYYY-MM-DD HH:MM:SS.uuuuuu"
+        static std::string StartLine(LogLevel level, size_t messageSize, long long& timestamp); // Timestamp and level prefix of a new line
+        static int Commit(long long timestamp, std::string&& line, uint32_t site=0); // Hands a finished line, or a site's encoded arguments, to the calling thread's staging ring
+        static long long Timestamp();
 
-        static void Write(void* data); // Function to write log messages to file
+        static void WriterLoop(LoggerConfig config); // Single consumer that collects every staging ring in batches
+        static void Write(const std::string& buffer); // Function to write a batch of log lines to file
 
     private:
-        static std::unique_ptr<MyThreadPool> pool;
-        static Queue<std::string> logQueue; // Thread-safe queue for log messages
+        static std::atomic<int> runtimeLevel;
+        static std::atomic<bool> binaryMode;
         std::string fileName;
-        static FILE* logFile;
         bool debugMode;
 };
 
-#endif //MYLOGGER_H
\ No newline at end of file
+namespace MyLoggerDetail {
+    // Number of "{}" in a format string, or SIZE_MAX when a brace is neither a placeholder nor an escaped "{{" or "}}"
+    constexpr size_t CountPlaceholders(const std::string_view format) {
+        size_t count=0;
+        for (size_t i=0;i<format.size();++i) {
+            if (format[i]!='{'&&format[i]!='}') continue;
+            if (i+1<format.size()&&format[i+1]==format[i]) ++i;
+            else if (format[i]=='{'&&i+1<format.size()&&format[i+1]=='}') {
+                ++count;
+                ++i;
+            }
+            else return SIZE_MAX;
+        }
+        return count;
+    }
+
+    template<class... Args>
+    std::integral_constant<size_t, sizeof...(Args)> CountArgs(const Args&...); // Only used unevaluated, so arguments are never computed
+
+    inline void AppendArg(std::string& out, const std::string_view value) {out.append(value);}
+    inline void AppendArg(std::string& out, const char* value) {out.append(value!=nullptr?value:"(null)");}
+    inline void AppendArg(std::string& out, char* value) {AppendArg(out, static_cast<const char*>(value));}
+    inline void AppendArg(std::string& out, const char value) {out.push_back(value);}
+    inline void AppendArg(std::string& out, const bool value) {out.append(value?"true":"false");}
+
+    template<class T>
+    std::enable_if_t<std::is_arithmetic_v<T>> AppendArg(std::string& out, const T value) {
+        char buffer[32];
+        const auto result=std::to_chars(buffer, buffer+sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    template<class T>
+    std::enable_if_t<std::is_enum_v<T>> AppendArg(std::string& out, const T value) {
+        AppendArg(out, static_cast<std::underlying_type_t<T>>(value));
+    }
+
+    template<class T>
+    void AppendArg(std::string& out, const T* value) {
+        char buffer[2+2*sizeof(void*)]={'0', 'x'};
+        const auto result=std::to_chars(buffer+2, buffer+sizeof(buffer), reinterpret_cast<uintptr_t>(value), 16);
+        out.append(buffer, result.ptr);
+    }
+
+    // Copies literal text up to the next placeholder, unescaping "{{" and "}}", and leaves pos just past the placeholder
+    inline void AppendLiteral(std::string& out, const std::string_view format, size_t& pos) {
+        while (pos<format.size()) {
+            const size_t brace=format.find_first_of("{}", pos);
+            if (brace==std::string_view::npos) {
+                out.append(format.substr(pos));
+                pos=format.size();
+                return;
+            }
+            out.append(format.substr(pos, brace-pos));
+            pos=brace+2;
+            if (brace+1<format.size()&&format[brace+1]==format[brace]) out.push_back(format[brace]);
+            else return;
+        }
+    }
+
+    template<class... Args>
+    void FormatTo(std::string& out, const std::string_view format, const Args&... args) {
+        size_t pos=0;
+        ((AppendLiteral(out, format, pos), AppendArg(out, args)), ...);
+        AppendLiteral(out, format, pos);
+    }
+
+    // Binary log file layout: BINARY_MAGIC followed by records, each starting with a varint kind
+    //   0       site: varint id, u8 level, varint line, then file, format and one ArgTag per argument as strings
+    //   1       base: varint timestamp in microseconds, later deltas are relative to it
+    //   2       text: zigzag varint timestamp delta, string with an already formatted line
+    //   id+2    line of that site: zigzag varint timestamp delta, then the arguments in the site's types
+    // Strings are a varint size and the bytes; integers are (zigzag) varints, doubles 8 bytes in host byte order
+    constexpr char BINARY_MAGIC[8]={'M', 'Y', 'L', 'O', 'G', 'B', '2', '\0'};
+    enum class ArgTag : uint8_t {Int, UInt, Double, Char, Bool, String, Pointer};
+
+    inline void PutVarint(std::string& out, uint64_t value) {
+        for (;value>=0x80;value>>=7)
+            out.push_back(static_cast<char>(value|0x80));
+        out.push_back(static_cast<char>(value));
+    }
+
+    constexpr uint64_t ZigZag(const int64_t value) {return static_cast<uint64_t>(value)<<1^static_cast<uint64_t>(value>>63);}
+
+    template<class T>
+    constexpr ArgTag TagOf() {
+        if constexpr (std::is_same_v<T, bool>) return ArgTag::Bool;
+        else if constexpr (std::is_same_v<T, char>) return ArgTag::Char;
+        else if constexpr (std::is_enum_v<T>) return TagOf<std::underlying_type_t<T>>();
+        else if constexpr (std::is_floating_point_v<T>) return ArgTag::Double;
+        else if constexpr (std::is_integral_v<T>) return std::is_signed_v<T>?ArgTag::Int:ArgTag::UInt;
+        else if constexpr (std::is_convertible_v<T, std::string_view>) return ArgTag::String;
+        else {
+            static_assert(std::is_pointer_v<T>, "unsupported log argument type");
+            return ArgTag::Pointer;
+        }
+    }
+
+    // The argument types of a call site, recorded once so the lines themselves carry no tags
+    template<class... Args>
+    struct ArgTypes {
+        static constexpr ArgTag tags[sizeof...(Args)+1]={TagOf<Args>()..., ArgTag::Int};
+        static std::string_view Tags() {return {reinterpret_cast<const char*>(tags), sizeof...(Args)};}
+    };
+
+    template<class... Args>
+    ArgTypes<std::decay_t<Args>...> ArgTypesOf(std::string_view format, const Args&...); // Only used unevaluated, like CountArgs
+
+    inline void EncodeArg(std::string& out, const std::string_view value) {
+        PutVarint(out, value.size());
+        out.append(value);
+    }
+    inline void EncodeArg(std::string& out, const char* value) {EncodeArg(out, std::string_view(value!=nullptr?value:"(null)"));}
+    inline void EncodeArg(std::string& out, char* value) {EncodeArg(out, static_cast<const char*>(value));}
+    inline void EncodeArg(std::string& out, const char value) {out.push_back(value);}
+    inline void EncodeArg(std::string& out, const bool value) {out.push_back(value?1:0);}
+
+    template<class T>
+    std::enable_if_t<std::is_arithmetic_v<T>> EncodeArg(std::string& out, const T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            const double widened=value;
+            out.append(reinterpret_cast<const char*>(&widened), sizeof(widened));
+        }
+        else if constexpr (std::is_signed_v<T>) PutVarint(out, ZigZag(value));
+        else PutVarint(out, value);
+    }
+
+    template<class T>
+    std::enable_if_t<std::is_enum_v<T>> EncodeArg(std::string& out, const T value) {
+        EncodeArg(out, static_cast<std::underlying_type_t<T>>(value));
+    }
+
+    template<class T>
+    void EncodeArg(std::string& out, const T* value) {PutVarint(out, reinterpret_cast<uintptr_t>(value));}
+}
+
+template<class... Args>
+int MyLogger::Log(const LogLevel level, const std::string_view format, const Args&... args) {
+    if (!Enabled(level)) return 0;
+
+    long long timestamp;
+    std::string line=StartLine(level, format.size()+16*sizeof...(Args), timestamp);
+    MyLoggerDetail::FormatTo(line, format, args...);
+    return Commit(timestamp, std::move(line));
+}
+
+template<class... Args>
+int MyLogger::LogBinary(const uint32_t site, std::string_view, const Args&... args) {
+    std::string payload;
+    (MyLoggerDetail::EncodeArg(payload, args), ...);
+    return Commit(Timestamp(), std::move(payload), site);
+}
+
+#define MYLOGGER_EXPAND(x) x
+#define MYLOGGER_FIRST_(first, ...) first
+#define MYLOGGER_FIRST(...) MYLOGGER_EXPAND(MYLOGGER_FIRST_(__VA_ARGS__, unused))
+
+// MYLOG_INFO("Client {} connected.", id): levels below MYLOGGER_MIN_LEVEL generate no code, levels disabled at
+// runtime never evaluate their arguments, and the placeholder count is checked against the arguments at compile time
+// In binary mode each call site registers once and then only stages its ID, a timestamp and the raw arguments
+#define MYLOGGER_LOG(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level)>=MYLOGGER_MIN_LEVEL) { \
+            static_assert(MyLoggerDetail::CountPlaceholders(MYLOGGER_FIRST(__VA_ARGS__))+1==decltype(MyLoggerDetail::CountArgs(__VA_ARGS__))::value, \
+                "log format placeholders do not match the arguments"); \
+            if (MyLogger::Enabled(level)) { \
+                if (MyLogger::Binary()) { \
+                    static const uint32_t mylogSite=MyLogger::RegisterSite(level, __FILE__, __LINE__, MYLOGGER_FIRST(__VA_ARGS__), \
+                        decltype(MyLoggerDetail::ArgTypesOf(__VA_ARGS__))::Tags()); \
+                    MyLogger::LogBinary(mylogSite, __VA_ARGS__); \
+                } \
+                else MyLogger::Log(level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define MYLOG_DEBUG(...) MYLOGGER_LOG(LogLevel::Debug, __VA_ARGS__)
+#define MYLOG_INFO(...) MYLOGGER_LOG(LogLevel::Info, __VA_ARGS__)
+#define MYLOG_WARNING(...) MYLOGGER_LOG(LogLevel::Warning, __VA_ARGS__)
+#define MYLOG_ERROR(...) MYLOGGER_LOG(LogLevel::Error, __VA_ARGS__)
+#define MYLOG_FATAL(...) MYLOGGER_LOG(LogLevel::Fatal, __VA_ARGS__)
+
+#endif //MYLOGGER_H
@@ -2,12 +2,41 @@
 #define MYSOCKETX_H
 
 #include <memory>
-#include <winsock2.h>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#include <cstdint>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef int SOCKET;
+typedef uint32_t DWORD;
+typedef sockaddr SOCKADDR;
+typedef sockaddr_in SOCKADDR_IN;
+typedef sockaddr_in6 SOCKADDR_IN6;
+
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+
+inline int closesocket(const SOCKET sock) {return close(sock);}
+#endif
+
+#include "FrameDecoder.h"
 #include "MyLogger.h"
+#include "SendQueue.h"
+#include "SmallVector.h"
+
+typedef unsigned int ui;
 
 #define DATA_SIZE 1024
+#define SEND_QUEUE_LIMIT (8*1024*1024) // 单个连接积压的发送数据上限，超过后SendTo失败
 
 enum class ProtocolType {
     TCP,
@@ -31,21 +60,47 @@ enum class ProcessState {
     CLOSE
 };
 
+enum class EventLoopType {
+    Auto, // Windows下为IOCP，Linux下优先io_uring，不可用时为epoll
+    IOCP,
+    Epoll,
+    IoUring
+};
+
 typedef ui ClientID;
 
+struct ContextPoolStats {
+    ui handlesInUse; // 正在使用的连接上下文
+    ui handlesHighWater;
+    ui ioInUse; // 正在使用的I/O上下文
+    ui ioHighWater;
+    ui capacity; // 已申请的上下文槽位总数
+};
+
+class MyEventLoop;
+
 class MySocketX {
     public:
         explicit MySocketX(const std::shared_ptr<MyLogger>& logger=nullptr);
         ~MySocketX();
 
         static bool Initialize();
+        static void SetEventLoop(EventLoopType type); // 需在Start之前调用
+        static void SetAcceptors(ui count, bool reusePort=false); // 需在Create之前调用
+        // 每个Work线程独占一个事件循环，连接固定由一个线程处理；count为0时等于CPU数，pin为true时将线程绑定到CPU
+        static void SetLoops(ui count, bool pin=false); // 需在Start之前调用
         static bool Create(ProtocolType protocolType, const std::string& IP, unsigned port,
             SocketType socketType, IPType ipType=IPType::IPv4);
         bool Start(void* extraData=nullptr);
-        void SaveClientInfo(SOCKET sock, void* extraData=nullptr);
+        void SaveClientInfo(SOCKET sock, void* extraData=nullptr, MyEventLoop* loop=nullptr);
         static bool SendTo(const std::string& data, ClientID id=0);
-        static void BroadCast(const std::string& data);
+        // 负载只拷贝一次，由各事件循环的Work线程分别写入自己的连接；group为空时发送给所有连接
+        static void BroadCast(const std::string& data, const std::string& group="");
+        static void BroadCast(const SharedPayload& payload, const std::string& group="");
+        static bool Subscribe(ClientID id, const std::string& group);
+        static bool Unsubscribe(ClientID id, const std::string& group);
         static void Close();
+        static ContextPoolStats GetPoolStats(); // 各事件循环上下文池的汇总，最高占用为各池之和
 
         virtual void OnConnect(SOCKET sock, void* data);
         virtual bool OnSend(SOCKET sock, void* data);
@@ -54,24 +109,46 @@ class MySocketX {
 
     private:
         static void Work(void* data);
+        void AcceptClient(SOCKET sock, MyEventLoop* loop=nullptr);
 
     public:
         typedef struct {
-            SOCKET socket;
-        }PER_HANDLE_DATA, *LPPER_HANDLE_DATA;
-
-        typedef struct {
+#ifdef _WIN32
             WSAOVERLAPPED overlapped;
             WSABUF wsabuf;
-            char* buffer=new char[DATA_SIZE];
+#endif
+            alignas(64) char buffer[DATA_SIZE];
             DWORD bytesReceived;
             DWORD bytesSent;
             SOCKET socket;
-            std::string accumulatedData;
+            FrameDecoder decoder; // 跨越多次接收的不完整帧
+            SendQueue sendData; // 发送请求持有的数据（IOCP）
             ProcessState state=ProcessState::DEFAULT;
             ClientID clientId;
         }PER_IO_DATA, *LPPER_IO_DATA;
 
+        typedef struct {
+            SOCKET socket;
+            ClientID clientId;
+            LPPER_IO_DATA recvData; // 该连接上的接收请求
+            MyEventLoop* loop; // 所属事件循环
+
+            SendQueue sendQueue; // 尚未交给内核的数据
+            void* pendingSend; // 正在进行的发送请求（io_uring和IOCP）
+#ifdef _WIN32
+            std::mutex sendLock; // 保护sendQueue和pendingSend，共享完成端口时Send和发送完成可能在不同线程
+#endif
+
+            size_t memberIndex; // 在所属循环连接列表中的位置
+            SmallVector<std::string, 2> groups; // 加入的分组，通常只有一两个，不单独申请内存
+        }PER_HANDLE_DATA, *LPPER_HANDLE_DATA;
+
+        // 传给OnReceive的数据，message指向一个完整帧的负载（不含长度前缀），只在回调期间有效
+        typedef struct {
+            std::string_view message;
+            LPPER_HANDLE_DATA handleData;
+        }UserData;
+
         static const std::string eof;
 
     private:
@@ -1,69 +1,473 @@
 #ifndef MYTHREADPOOL_H
 #define MYTHREADPOOL_H
 
-#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-#include "Queue.h"
-#include "Vector.h"
+#include "AdaptiveMutex.h"
+#include "BoundedQueue.h"
+#include "Task.h"
 
-class MyThreadPool {
-    public:
-        struct Job {
-            void (*Function)(void *); // 任务函数
-            void* Data;
+typedef unsigned int ui;
+
+class MyThreadPool;
+
+// 任务优先级，取任务时依次检查realtime、normal、background队列，并定期优先检查低优先级队列防止饿死
+enum class Priority : uint8_t {
+    Realtime,
+    Normal,
+    Background
+};
+
+namespace ThreadPoolDetail {
+    // 同一大小的FutureState的线程本地空闲链表，Submit通常不申请堆内存
+    // 最后一个引用常在Work线程释放，本地链表满时把一批节点交给共享链表，本地为空时从共享链表取回一批
+    template<size_t Size>
+    class StateCache {
+        struct Node {
+            Node* next;
         };
 
-        struct Worker {
-            Worker():Pool(nullptr) {}
-            pthread_t ThreadID{};
-            MyThreadPool *Pool;
+        struct Shared {
+            ~Shared() {
+                while (head!=nullptr)
+                    ::operator delete(std::exchange(head, head->next));
+            }
+
+            AdaptiveMutex mutex;
+            Node* head=nullptr;
         };
 
+        public:
+            StateCache()=default;
+            ~StateCache() { // 线程退出时释放本地节点
+                while (head!=nullptr)
+                    ::operator delete(std::exchange(head, head->next));
+            }
+            StateCache(const StateCache&)=delete;
+            StateCache& operator=(const StateCache&)=delete;
+
+            static StateCache& Local() {
+                thread_local StateCache cache;
+                return cache;
+            }
+
+            void* Allocate() {
+                if (head==nullptr&&!Refill()) return ::operator new(Size);
+                --count;
+                return std::exchange(head, head->next);
+            }
+
+            void Free(void* p) {
+                head=new(p) Node{head};
+                if (++count>=LIMIT) Spill();
+            }
+
+        private:
+            static constexpr size_t LIMIT=256;
+            static constexpr size_t BATCH=LIMIT/2;
+
+            static Shared& Global() {
+                static Shared shared;
+                return shared;
+            }
+
+            bool Refill() {
+                Shared& shared=Global();
+                std::lock_guard lock(shared.mutex);
+                while (shared.head!=nullptr&&count<BATCH) {
+                    head=new(std::exchange(shared.head, shared.head->next)) Node{head};
+                    ++count;
+                }
+                return head!=nullptr;
+            }
+
+            void Spill() {
+                // 先在本地摘下一批，持锁时只拼接链表
+                Node* first=head;
+                Node* last=head;
+                for (size_t i=1;i<BATCH;++i)
+                    last=last->next;
+                head=last->next;
+                count-=BATCH;
+
+                Shared& shared=Global();
+                std::lock_guard lock(shared.mutex);
+                last->next=shared.head;
+                shared.head=first;
+            }
+
+            Node* head=nullptr;
+            size_t count=0;
+    };
+
+    // Future与任务共享的结果，两端各持有一个引用
+    template<class R>
+    struct FutureState {
+        enum : uint32_t {PENDING=0, READY=1, WAITING=2}; // WAITING表示有线程在futex上等待
+
+        explicit FutureState(MyThreadPool* pool):pool(pool) {}
+
+        // 大小按16字节取整后共用缓存，结果类型不同但大小相近的状态可以互相复用；超对齐的类型直接使用堆
+        static void* operator new(const size_t size) {
+            if constexpr (alignof(FutureState)<=__STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                return StateCache<(sizeof(FutureState)+15)/16*16>::Local().Allocate();
+            else return ::operator new(size, std::align_val_t(alignof(FutureState)));
+        }
+        static void operator delete(void* p) {
+            if constexpr (alignof(FutureState)<=__STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                StateCache<(sizeof(FutureState)+15)/16*16>::Local().Free(p);
+            else ::operator delete(p, std::align_val_t(alignof(FutureState)));
+        }
+
+        void Release() {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel)==1) delete this;
+        }
+
+        void Finish() {
+            if (status.exchange(READY, std::memory_order_acq_rel)==WAITING) FutexWake(&status, true);
+        }
+
+        MyThreadPool* pool;
+        std::atomic<uint32_t> status{PENDING};
+        std::atomic<uint32_t> refs{2};
+        std::conditional_t<std::is_void_v<R>, bool, std::optional<R>> value{};
+        std::exception_ptr error;
+    };
+
+    // 执行函数并把结果或异常写入FutureState
+    // 未执行就销毁时（如超过截止时间被丢弃）向Future报告异常，避免等待方永远阻塞
+    template<class R, class F>
+    class FutureTask {
+        public:
+            FutureTask(FutureState<R>* state, F&& fn):state(state), fn(std::move(fn)) {}
+            FutureTask(FutureTask&& other) noexcept(std::is_nothrow_move_constructible_v<F>):state(std::exchange(other.state, nullptr)), fn(std::move(other.fn)) {}
+            FutureTask& operator=(FutureTask&&)=delete;
+            ~FutureTask();
+
+            void operator()() {
+                try {
+                    if constexpr (std::is_void_v<R>) fn();
+                    else state->value.emplace(fn());
+                }
+                catch (...) {
+                    state->error=std::current_exception();
+                }
+                state->Finish();
+                state->Release();
+                state=nullptr;
+            }
+
+        private:
+            FutureState<R>* state;
+            F fn;
+    };
+
+    template<class R, class F>
+    FutureTask<R, F>::~FutureTask() {
+        if (state==nullptr) return;
+        state->error=std::make_exception_ptr(std::runtime_error("task dropped before it ran"));
+        state->Finish();
+        state->Release();
+    }
+
+    // ParallelFor/ParallelReduce的共享状态，把区间按grain切成分块，调用方和辅助任务用原子计数领取
+    // 调用方只等待所有分块完成，不等待辅助任务本身，尚未执行的辅助任务稍后运行时发现没有分块直接退出
+    struct ForkState {
+        enum : uint32_t {RUNNING=0, DONE=1, WAITING=2}; // WAITING表示调用方在futex上等待
+
+        void Work(); // 领取并执行分块直到没有剩余
+        void Release();
+
+        size_t begin;
+        size_t end;
+        size_t grain;
+        size_t chunks;
+        void* body; // 调用方栈上的函数对象，只在领取到分块时访问
+        void (*run)(void* body, size_t chunk, size_t first, size_t last);
+
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        std::atomic<uint32_t> status{RUNNING};
+        std::atomic<uint32_t> refs{1};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error; // 第一个失败分块的异常
+    };
+}
+
+// Submit返回的结果句柄，只可移动
+template<class R>
+class Future {
     public:
-        MyThreadPool()=default;
-        explicit MyThreadPool(ui maxWorker);
+        Future()=default;
+        Future(Future&& other) noexcept:state(std::exchange(other.state, nullptr)) {}
+        Future& operator=(Future&& other) noexcept;
+        Future(const Future&)=delete;
+        Future& operator=(const Future&)=delete;
+        ~Future() {if (state!=nullptr) state->Release();}
+
+        [[nodiscard]] bool Valid()const {return state!=nullptr;}
+        [[nodiscard]] bool Ready()const;
+        void Wait()const; // 在池内线程调用时先帮助执行其他任务，避免所有线程互相等待
+        R Get(); // 等待并取出结果，任务抛出的异常在此重新抛出，之后Future失效
+
+    private:
+        friend class MyThreadPool;
+        explicit Future(ThreadPoolDetail::FutureState<R>* state):state(state) {}
+
+    private:
+        ThreadPoolDetail::FutureState<R>* state=nullptr;
+};
+
+// 线程池的伸缩配置，minWorker==maxWorker时线程数固定，不启动控制线程
+struct ThreadPoolConfig {
+    ui minWorker=1; // 常驻线程数
+    ui maxWorker=0; // 最大线程数，为0时取CPU核心数
+    std::chrono::milliseconds idleTimeout{30000}; // 超出常驻数的线程空闲该时长后退出
+    size_t spawnQueueDepth=1; // 没有空闲线程且排队任务数不少于该值时按排队数增加线程
+    std::chrono::microseconds spawnWaitTime{2000}; // 没有空闲线程且最近任务的平均等待时间超过该值时增加一个线程
+    std::chrono::milliseconds checkInterval{10}; // 控制线程的检查周期
+};
+
+// 线程池运行状态，各项分别读取，不是同一时刻的快照
+struct ThreadPoolStats {
+    ui workers; // 当前线程数
+    ui idleWorkers; // 休眠中的线程数
+    size_t queuedJobs; // 排队中的任务数
+    uint64_t completedJobs; // 已开始执行的任务数
+    uint64_t expiredJobs; // 超过截止时间被丢弃的任务数
+    double averageWaitMicros; // 任务从提交到开始执行的平均等待时间
+    double maxWaitMicros; // 最长等待时间
+};
+
+// 工作窃取线程池
+// 每个线程持有一个Chase-Lev双端队列，线程池内部提交的任务压入本线程队列，外部提交的任务进入全局注入队列
+// 线程依次从本地队列、注入队列和其他线程的队列取任务，都为空时在futex上休眠
+// 提交任务不加锁，只有存在休眠线程时才进入内核唤醒；任务内联存放在队列槽位中，小任务提交不申请堆内存
+// 每个优先级有独立的注入队列，池内线程提交的普通任务才进入本地队列；超过截止时间仍未开始的任务被丢弃
+// 线程数在minWorker和maxWorker之间伸缩：所有线程忙碌且有任务排队时由控制线程增加线程，空闲超时的线程自行退出
+class MyThreadPool {
+    public:
+        MyThreadPool(); // 按默认配置伸缩
+        explicit MyThreadPool(ui maxWorker); // 固定线程数
+        explicit MyThreadPool(const ThreadPoolConfig& config);
         ~MyThreadPool();
+        MyThreadPool(const MyThreadPool&)=delete;
+        MyThreadPool& operator=(const MyThreadPool&)=delete;
 
     public:
-        void* CacheProcess(void* data); // 控制线程池运行
+        void StopAll(); // 执行完已提交的任务后停止所有线程
 
-        void StopAll(); // 停止所有线程
+        void PushJob(void (*Function)(void*), void* Data);
+        void Post(Task task, Priority priority=Priority::Normal); // 提交任务，不关心结果
+        // 到deadline仍未开始执行的任务直接丢弃，不再执行
+        void Post(Task task, Priority priority, std::chrono::steady_clock::time_point deadline);
+        void PushJobs(Task* tasks, size_t count, Priority priority=Priority::Normal); // 批量提交，只唤醒一次
 
-        static void* Run(void* data); // 执行任务
+        [[nodiscard]] ThreadPoolStats Stats()const;
+        // 提交f(args...)，返回其结果；参数按值保存
+        template<class F, class... Args>
+        auto Submit(F&& f, Args&&... args)->Future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>;
+        template<class F, class... Args>
+        auto Submit(Priority priority, F&& f, Args&&... args)->Future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>;
 
-        void* ThreadLoop(void* data); // 线程循环
+        // 对[begin, end)中的每个i并行调用fn(i)，返回时全部完成；grain为每个分块的元素数，为0时按线程数自动选择
+        // 调用线程同样参与执行，任一调用抛出的异常在返回前重新抛出
+        template<class F>
+        void ParallelFor(size_t begin, size_t end, size_t grain, F&& fn);
+        // 对每个分块调用body(first, last)得到部分结果，再按分块顺序用reduce(T, T)与identity依次合并
+        template<class T, class F, class R>
+        T ParallelReduce(size_t begin, size_t end, size_t grain, T identity, F&& body, R&& reduce);
 
-        void PushJob(void (*Function)(void*), void* Data);
+    private:
+        template<class R>
+        friend class Future;
 
-    protected:
-        struct Locker {
-            explicit Locker(pthread_mutex_t *mutex):mutex(mutex) {
-                ui attempt=1;
-                constexpr ui maxAttempts=1000;
-                while(pthread_mutex_trylock(mutex)!=0&&attempt<maxAttempts)
-                    std::this_thread::sleep_for(std::chrono::microseconds(attempt<<=1)); // 等待锁
-                if (attempt>=maxAttempts) locked=false; // 极端情况
-                else locked=true;
-            }
-            ~Locker() {pthread_mutex_unlock(mutex);}
+        class WorkDeque; // 线程本地的Chase-Lev队列
+
+        static constexpr size_t PRIORITY_COUNT=3;
+
+        struct PendingTask {
+            Task task;
+            int64_t enqueueTime=0; // 提交时刻，用于统计等待时间
+            int64_t deadline=0; // 为0时没有截止时间
+        };
+
+        // 每个优先级一个注入队列，满时转入后备队列
+        struct Lane {
+            std::unique_ptr<BoundedQueue<PendingTask>> queue;
+            AdaptiveMutex overflowMutex;
+            std::deque<PendingTask> overflow;
+            std::atomic<size_t> overflowSize{0};
+        };
+
+        enum WorkerState : uint8_t {STOPPED, RUNNING, EXITED};
 
-            bool locked;
-            pthread_mutex_t *mutex;
+        // 槽位按maxWorker预先分配，线程退出后槽位保留，由控制线程回收并复用
+        struct alignas(64) Worker {
+            std::thread thread;
+            std::unique_ptr<WorkDeque> deque;
+            std::atomic<uint8_t> state{STOPPED};
+            // 只由所在线程写入
+            std::atomic<uint64_t> jobs{0};
+            std::atomic<uint64_t> waitNanos{0};
+            std::atomic<uint64_t> maxWaitNanos{0};
+            std::atomic<uint64_t> expired{0};
+            uint32_t picks=0; // 取任务次数，用于定期优先检查低优先级队列
         };
 
+        void ThreadLoop(ui index); // 线程循环
+        void ControlLoop(); // 按排队情况增加线程并回收已退出的线程
+        void StartWorker(ui index);
+        bool TryRetire(); // 当前线程数多于minWorker时减一
+        void RequestSpawn();
+        void Execute(ui index, PendingTask& pending); // 记录等待时间并执行
+        void Enqueue(PendingTask&& pending, Priority priority);
+        bool TakeJob(ui index, PendingTask& pending);
+        bool TakeFromLane(Priority priority, PendingTask& pending);
+        bool Steal(ui index, PendingTask& pending);
+        bool HasJob()const;
+        size_t QueuedJobs()const;
+        void Wake(bool all);
+        bool RunOne(); // 在池内线程上执行一个待处理任务，没有任务或不在池内时返回false
+        size_t GrainSize(size_t count, size_t grain)const; // grain为0时使分块数约为线程数的4倍
+        void ForkJoin(ThreadPoolDetail::ForkState& state); // 派发辅助任务、参与执行并等待所有分块完成
+
     private:
+        ThreadPoolConfig config;
         ui maxWorker{};
-        ui freeWorker{}; // 空闲线程数
-        bool terminate{};
-
-        Queue<Job*> taskList; // 任务队列
-        Vector<Worker> workers;
-        pthread_t controlThreadID{};
-        pthread_mutex_t mutex{};
-        pthread_mutex_t counterMutex{};
-        pthread_cond_t cond{};
-        pthread_cond_t cacheCond{}; // 用于控制线程池运行
+        bool elastic=false; // 线程数可伸缩时才启动控制线程
+        std::unique_ptr<Worker[]> workers;
+        Lane lanes[PRIORITY_COUNT];
+        std::atomic<bool> terminate{false};
+        std::atomic<ui> live{0}; // 当前线程数
+
+        std::thread controlThread;
+        std::atomic<uint32_t> controlEpoch{0}; // 控制线程在其上定时等待
+        std::atomic<bool> spawnRequested{false};
+
+        std::atomic<ui> sleepers{0}; // 正在休眠或准备休眠的线程数
+        std::atomic<uint32_t> wakeEpoch{0}; // 每次唤醒加一，休眠线程在其上等待
 };
 
+template<class R>
+Future<R>& Future<R>::operator=(Future&& other) noexcept {
+    if (this!=&other) {
+        if (state!=nullptr) state->Release();
+        state=std::exchange(other.state, nullptr);
+    }
+    return *this;
+}
+
+template<class R>
+bool Future<R>::Ready()const {
+    return state!=nullptr&&state->status.load(std::memory_order_acquire)==ThreadPoolDetail::FutureState<R>::READY;
+}
+
+template<class R>
+void Future<R>::Wait()const {
+    using State=ThreadPoolDetail::FutureState<R>;
+
+    while (!Ready()) {
+        if (state->pool->RunOne()) continue;
+
+        uint32_t status=state->status.load(std::memory_order_acquire);
+        if (status==State::READY) break;
+        if (status==State::PENDING&&!state->status.compare_exchange_weak(status, State::WAITING, std::memory_order_acq_rel))
+            continue;
+        FutexWait(&state->status, State::WAITING);
+    }
+}
+
+template<class R>
+R Future<R>::Get() {
+    Wait();
+    Future done(std::move(*this)); // 返回时释放引用
+
+    if (done.state->error) std::rethrow_exception(done.state->error);
+    if constexpr (!std::is_void_v<R>) return std::move(*done.state->value);
+}
+
+template<class F, class... Args>
+auto MyThreadPool::Submit(F&& f, Args&&... args)->Future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+    return Submit(Priority::Normal, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<class F, class... Args>
+auto MyThreadPool::Submit(const Priority priority, F&& f, Args&&... args)->Future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+    using R=std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+    auto* state=new ThreadPoolDetail::FutureState<R>(this);
+
+    // 没有参数时直接保存f，不额外占用tuple的空间
+    if constexpr (sizeof...(Args)==0)
+        Post(ThreadPoolDetail::FutureTask<R, std::decay_t<F>>(state, std::decay_t<F>(std::forward<F>(f))), priority);
+    else {
+        auto bound=[fn=std::forward<F>(f), params=std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            return std::apply(fn, std::move(params));
+        };
+        Post(ThreadPoolDetail::FutureTask<R, decltype(bound)>(state, std::move(bound)), priority);
+    }
+    return Future<R>(state);
+}
+
+template<class F>
+void MyThreadPool::ParallelFor(const size_t begin, const size_t end, const size_t grain, F&& fn) {
+    if (begin>=end) return;
+
+    auto* state=new ThreadPoolDetail::ForkState;
+    state->begin=begin;
+    state->end=end;
+    state->grain=GrainSize(end-begin, grain);
+    state->body=&fn;
+    state->run=[](void* body, size_t, const size_t first, const size_t last) {
+        auto& f=*static_cast<std::remove_reference_t<F>*>(body);
+        for (size_t i=first;i<last;++i)
+            f(i);
+    };
+    ForkJoin(*state);
+}
+
+template<class T, class F, class R>
+T MyThreadPool::ParallelReduce(const size_t begin, const size_t end, const size_t grain, T identity, F&& body, R&& reduce) {
+    if (begin>=end) return identity;
+
+    struct Body {
+        std::remove_reference_t<F>* body;
+        std::vector<std::optional<T>> partials;
+    } context{&body, {}};
+
+    auto* state=new ThreadPoolDetail::ForkState;
+    state->begin=begin;
+    state->end=end;
+    state->grain=GrainSize(end-begin, grain);
+    context.partials.resize((end-begin+state->grain-1)/state->grain);
+    state->body=&context;
+    state->run=[](void* body, const size_t chunk, const size_t first, const size_t last) {
+        auto& ctx=*static_cast<Body*>(body);
+        ctx.partials[chunk].emplace((*ctx.body)(first, last));
+    };
+    ForkJoin(*state);
+
+    T result=std::move(identity);
+    for (auto& partial : context.partials)
+        result=reduce(std::move(result), std::move(*partial));
+    return result;
+}
+
 #endif //MYTHREADPOOL_H
@@ -0,0 +1,131 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+// 固定大小对象的slab分配器
+// 每次按SlabSize个槽位整块申请内存，释放的槽位挂到空闲链表上复用，析构时统一归还
+// 槽位按缓存行对齐，相邻对象不会共享缓存行
+template<class T, unsigned SlabSize=64>
+class Pool {
+    using ui=unsigned int;
+
+    public:
+        Pool()=default;
+        ~Pool();
+        Pool(const Pool&)=delete;
+        Pool& operator=(const Pool&)=delete;
+
+        template<class... Args>
+        T* Acquire(Args&&... args); // 取出槽位并构造对象
+        void Release(T* object); // 析构对象并归还槽位
+
+        [[nodiscard]] ui InUse()const; // 当前占用的槽位数
+        [[nodiscard]] ui HighWater()const; // 占用数的历史最大值
+        [[nodiscard]] ui Capacity()const; // 已申请的槽位总数
+
+    private:
+        static constexpr size_t CACHE_LINE=64;
+
+        union alignas(alignof(T)>CACHE_LINE?alignof(T):CACHE_LINE) Slot {
+            Slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        struct Slab {
+            Slot slots[SlabSize];
+            Slab* next;
+        };
+
+        void Grow(); // 调用方需持有mutex
+
+    private:
+        Slot* freeList=nullptr;
+        Slab* slabs=nullptr;
+        ui inUse=0;
+        ui highWater=0;
+        ui capacity=0;
+        mutable std::mutex mutex;
+};
+
+template<class T, unsigned SlabSize>
+Pool<T, SlabSize>::~Pool() {
+    // 仍被占用的对象由使用者负责析构，这里只归还内存
+    while (slabs!=nullptr) {
+        Slab* next=slabs->next;
+        ::operator delete(slabs, std::align_val_t(alignof(Slab)));
+        slabs=next;
+    }
+}
+
+template<class T, unsigned SlabSize>
+template<class... Args>
+T* Pool<T, SlabSize>::Acquire(Args&&... args) {
+    Slot* slot;
+    {
+        std::lock_guard lock(mutex);
+        if (freeList==nullptr) Grow();
+        slot=freeList;
+        freeList=slot->next;
+        if (++inUse>highWater) highWater=inUse;
+    }
+
+    try {
+        return new(slot->storage) T(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        std::lock_guard lock(mutex);
+        slot->next=freeList;
+        freeList=slot;
+        --inUse;
+        throw;
+    }
+}
+
+template<class T, unsigned SlabSize>
+void Pool<T, SlabSize>::Release(T* object) {
+    if (object==nullptr) return;
+    object->~T();
+
+    const auto slot=reinterpret_cast<Slot*>(object);
+    std::lock_guard lock(mutex);
+    slot->next=freeList;
+    freeList=slot;
+    --inUse;
+}
+
+template<class T, unsigned SlabSize>
+unsigned int Pool<T, SlabSize>::InUse()const {
+    std::lock_guard lock(mutex);
+    return inUse;
+}
+
+template<class T, unsigned SlabSize>
+unsigned int Pool<T, SlabSize>::HighWater()const {
+    std::lock_guard lock(mutex);
+    return highWater;
+}
+
+template<class T, unsigned SlabSize>
+unsigned int Pool<T, SlabSize>::Capacity()const {
+    std::lock_guard lock(mutex);
+    return capacity;
+}
+
+template<class T, unsigned SlabSize>
+void Pool<T, SlabSize>::Grow() {
+    const auto slab=static_cast<Slab*>(::operator new(sizeof(Slab), std::align_val_t(alignof(Slab))));
+    slab->next=slabs;
+    slabs=slab;
+
+    for (ui i=SlabSize;i>0;--i) {
+        slab->slots[i-1].next=freeList;
+        freeList=&slab->slots[i-1];
+    }
+    capacity+=SlabSize;
+}
+
+#endif //POOL_H
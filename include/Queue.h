@@ -1,95 +1,277 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
+// 加锁的环形队列，容量不足时加倍
+// 元素构造在未初始化的存储中，不要求T可默认构造；扩容时移动元素，可平凡复制的类型直接memcpy
+// 消费者可以阻塞等待，也可以一次加锁取走一批元素；Close()之后不再接受入队，等待中的消费者取完剩余元素后返回
 template<class T>
 class Queue {
     using ui=unsigned int;
 
     public:
-        Queue(); // 构造函数
+        explicit Queue(ui capacity=0); // 初始容量，为0时第一次入队才分配
         ~Queue(); // 析构函数
-        void Push(const T& val); // 入队
+        Queue(const Queue&)=delete;
+        Queue& operator=(const Queue&)=delete;
+
+        bool Push(const T& val); // 入队，队列已关闭时返回false
+        bool Push(T&& val);
+        template<class... Args>
+        bool Emplace(Args&&... args); // 在队尾原地构造
         void Pop(); // 出队
+        bool Pop(T& val); // 队首元素移动到val后出队，队列为空时返回false
+        bool PopWait(T& val); // 队列为空时等待，队列已关闭且为空时返回false
+        template<class Rep, class Period>
+        bool PopWait(T& val, const std::chrono::duration<Rep, Period>& timeout); // 超时返回false
+        template<class Container>
+        ui DrainTo(Container& out, ui max=UINT_MAX); // 一次加锁取走至多max个元素追加到out，返回个数
+        template<class Container, class Rep, class Period>
+        ui DrainTo(Container& out, ui max, const std::chrono::duration<Rep, Period>& timeout); // 队列为空时先等待
+        void Close(); // 关闭队列并唤醒所有等待的消费者
+        void Reopen(); // 重新接受入队
+        [[nodiscard]] bool Closed()const;
         T& Front(); // 返回队首元素
         T& Back(); // 返回队尾元素
         [[nodiscard]] bool Empty()const; // 判断队列是否为空
         [[nodiscard]] ui Size()const; // 返回队列大小
-        void Clear(); // 清空队列
+        void Reserve(ui capacity); // 预留容量，避免启动阶段反复扩容
+        void Clear(); // 清空队列，保留容量
+
+    private:
+        static constexpr ui MIN_CAPACITY=8;
+
+        T* At(ui index)const {return Data+(Head+index)%Capacity;} // 第index个元素的位置
+        void Grow(ui capacity); // 调用方需持有mutex
+        void PopFront(T& val); // 调用方需持有mutex且队列非空
+        template<class Container>
+        ui DrainLocked(Container& out, ui max);
 
     private:
-        T* Data;
-        ui Head; // 队列头指针
-        ui queueSize;
-        ui Capacity; // 队列容量
+        std::allocator<T> allocator;
+        T* Data=nullptr;
+        ui Head=0; // 队列头指针
+        ui queueSize=0;
+        ui Capacity=0; // 队列容量
+        bool closed=false;
+        ui waiters=0; // 等待中的消费者数，没有消费者等待时入队不调用notify
         mutable std::mutex mutex;
+        std::condition_variable notEmpty;
 };
 
 template<class T>
-Queue<T>::Queue(): Head(0), queueSize(0), Capacity(1) {
-    Data=new T[Capacity];
+Queue<T>::Queue(const ui capacity) {
+    if (capacity>0) Grow(capacity);
 }
 
 template<class T>
 Queue<T>::~Queue() {
     std::lock_guard lock(mutex);
-    delete[] Data;
+    for (ui i=0;i<queueSize;++i)
+        std::destroy_at(At(i));
+    if (Data!=nullptr) allocator.deallocate(Data, Capacity);
 }
 
 template<class T>
-void Queue<T>::Push(const T& val) {
-    std::lock_guard lock(mutex);
-    if(queueSize==Capacity) { // 队列满
-        T* NewData=new T[Capacity*2]; // 扩容
-        for(ui i=Head, len=Head+Capacity;i<len;++i)
-            NewData[i-Head]=Data[i%Capacity];
-        delete[] Data;
-        Data=NewData;
-        Head=0;
-        Capacity*=2;
+bool Queue<T>::Push(const T& val) {
+    return Emplace(val);
+}
+
+template<class T>
+bool Queue<T>::Push(T&& val) {
+    return Emplace(std::move(val));
+}
+
+template<class T>
+template<class... Args>
+bool Queue<T>::Emplace(Args&&... args) {
+    bool notify;
+    {
+        std::lock_guard lock(mutex);
+        if (closed) return false;
+        if (queueSize==Capacity) // 队列满
+            Grow(Capacity<MIN_CAPACITY/2?MIN_CAPACITY:Capacity*2); // 扩容
+        ::new(static_cast<void*>(At(queueSize))) T(std::forward<Args>(args)...);
+        ++queueSize;
+        notify=waiters>0;
     }
-    Data[((queueSize++)+Head)%Capacity]=val;
+    if (notify) notEmpty.notify_one();
+    return true;
 }
 
 template<class T>
 void Queue<T>::Pop() {
     std::lock_guard lock(mutex);
-    if (Empty())throw std::underflow_error("Queue is empty");
+    if (queueSize==0) throw std::underflow_error("Queue is empty");
+    std::destroy_at(At(0));
     Head=(Head+1)%Capacity;
     --queueSize;
 }
 
+template<class T>
+bool Queue<T>::Pop(T& val) {
+    std::lock_guard lock(mutex);
+    if (queueSize==0) return false;
+    PopFront(val);
+    return true;
+}
+
+template<class T>
+bool Queue<T>::PopWait(T& val) {
+    std::unique_lock lock(mutex);
+    ++waiters;
+    notEmpty.wait(lock, [this] {return queueSize>0||closed;});
+    --waiters;
+    if (queueSize==0) return false; // 已关闭
+    PopFront(val);
+    return true;
+}
+
+template<class T>
+template<class Rep, class Period>
+bool Queue<T>::PopWait(T& val, const std::chrono::duration<Rep, Period>& timeout) {
+    std::unique_lock lock(mutex);
+    ++waiters;
+    notEmpty.wait_for(lock, timeout, [this] {return queueSize>0||closed;});
+    --waiters;
+    if (queueSize==0) return false; // 超时或已关闭
+    PopFront(val);
+    return true;
+}
+
+template<class T>
+template<class Container>
+unsigned int Queue<T>::DrainTo(Container& out, const ui max) {
+    std::lock_guard lock(mutex);
+    return DrainLocked(out, max);
+}
+
+template<class T>
+template<class Container, class Rep, class Period>
+unsigned int Queue<T>::DrainTo(Container& out, const ui max, const std::chrono::duration<Rep, Period>& timeout) {
+    std::unique_lock lock(mutex);
+    ++waiters;
+    notEmpty.wait_for(lock, timeout, [this] {return queueSize>0||closed;});
+    --waiters;
+    return DrainLocked(out, max);
+}
+
+template<class T>
+void Queue<T>::Close() {
+    {
+        std::lock_guard lock(mutex);
+        closed=true;
+    }
+    notEmpty.notify_all();
+}
+
+template<class T>
+void Queue<T>::Reopen() {
+    std::lock_guard lock(mutex);
+    closed=false;
+}
+
+template<class T>
+bool Queue<T>::Closed()const {
+    std::lock_guard lock(mutex);
+    return closed;
+}
+
 template<class T>
 T& Queue<T>::Front() {
     if (Empty()) throw std::underflow_error("Queue is empty");
-    return Data[Head];
+    return *At(0);
 }
 
 template<class T>
 T& Queue<T>::Back() {
     if (Empty()) throw std::underflow_error("Queue is empty");
-    return Data[(Head+queueSize-1)%Capacity];
+    return *At(queueSize-1);
 }
 
 template<class T>
 bool Queue<T>::Empty()const {
+    std::lock_guard lock(mutex);
     return queueSize==0;
 }
 
 template<class T>
 unsigned int Queue<T>::Size()const {
+    std::lock_guard lock(mutex);
     return queueSize;
 }
 
+template<class T>
+void Queue<T>::Reserve(const ui capacity) {
+    std::lock_guard lock(mutex);
+    if (capacity>Capacity) Grow(capacity);
+}
+
 template<class T>
 void Queue<T>::Clear() {
     std::lock_guard lock(mutex);
-    delete[] Data;
-    Data=new T[1];
-    Capacity=1;
+    for (ui i=0;i<queueSize;++i)
+        std::destroy_at(At(i));
     Head=queueSize=0;
 }
 
+template<class T>
+void Queue<T>::PopFront(T& val) {
+    val=std::move(*At(0));
+    std::destroy_at(At(0));
+    Head=(Head+1)%Capacity;
+    --queueSize;
+}
+
+template<class T>
+template<class Container>
+unsigned int Queue<T>::DrainLocked(Container& out, const ui max) {
+    const ui count=std::min(queueSize, max);
+    for (ui i=0;i<count;++i) {
+        T* element=At(i);
+        out.push_back(std::move(*element));
+        std::destroy_at(element);
+    }
+    Head=queueSize==count?0:(Head+count)%Capacity;
+    queueSize-=count;
+    return count;
+}
+
+template<class T>
+void Queue<T>::Grow(const ui capacity) {
+    T* NewData=allocator.allocate(capacity);
+
+    // 环形存储最多分成两段，按顺序搬到新存储的开头
+    if (queueSize>0) {
+        const ui first=std::min(queueSize, Capacity-Head);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            memcpy(static_cast<void*>(NewData), Data+Head, first*sizeof(T));
+            memcpy(static_cast<void*>(NewData+first), Data, (queueSize-first)*sizeof(T));
+        }
+        else {
+            for (ui i=0;i<queueSize;++i) {
+                T* element=At(i);
+                ::new(static_cast<void*>(NewData+i)) T(std::move_if_noexcept(*element));
+                std::destroy_at(element);
+            }
+        }
+    }
+
+    if (Data!=nullptr) allocator.deallocate(Data, Capacity);
+    Data=NewData;
+    Head=0;
+    Capacity=capacity;
+}
+
 #endif //QUEUE_H
@@ -0,0 +1,170 @@
+#ifndef SENDQUEUE_H
+#define SENDQUEUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::shared_ptr<const std::string> SharedPayload; // 多个连接共用的只读数据
+
+// 连接的待发送队列，本身不加锁，由调用方保护
+// 小消息追加到末尾的数据块中合并，大消息单独成块；写出时把数据块收集为分散/聚集数组一次提交
+// 共享负载只增加引用计数，不拷贝数据
+class SendQueue {
+    public:
+        // shared不为空时data指向*shared内部，只引用不拷贝
+        void Push(const char* data, size_t len, const SharedPayload* shared=nullptr);
+        void Push(std::string&& data);
+
+        // 按顺序对最多maxCount个数据片段调用visit(index, const char* data, size_t len)，返回片段数
+        template<class F>
+        unsigned Gather(unsigned maxCount, F&& visit)const;
+        void Consume(size_t len); // 移除已写出的字节
+        size_t CopyTo(char* buffer, size_t len); // 拷贝并移除队首最多len字节
+        void MoveTo(SendQueue& other, unsigned maxCount, size_t maxBytes); // 将队首的数据块整体转移
+
+        [[nodiscard]] bool Empty()const {return bytes==0;}
+        [[nodiscard]] size_t Bytes()const {return bytes;}
+        [[nodiscard]] bool HasShared()const {return sharedCount>0;} // 是否有数据块引用共享负载
+        void Clear();
+
+    private:
+        static constexpr size_t COALESCE_SIZE=16*1024; // 末尾数据块不超过该大小时继续合并
+        static constexpr size_t COMPACT_COUNT=16; // 已写完的数据块超过该数量时整理数组
+
+        struct Chunk {
+            std::string owned{};
+            SharedPayload shared{}; // 非空时数据位于共享负载中
+            const char* view=nullptr;
+            size_t viewSize=0;
+
+            [[nodiscard]] const char* Data()const {return shared?view:owned.data();}
+            [[nodiscard]] size_t Size()const {return shared?viewSize:owned.size();}
+        };
+
+        void PopFront();
+
+    private:
+        std::vector<Chunk> chunks;
+        size_t first=0; // 第一个未写完的数据块
+        size_t offset=0; // 第一个数据块中已写出的字节数
+        size_t bytes=0;
+        size_t sharedCount=0; // 引用共享负载的数据块数
+};
+
+template<class F>
+unsigned SendQueue::Gather(const unsigned maxCount, F&& visit)const {
+    unsigned count=0;
+    for (size_t i=first;i<chunks.size()&&count<maxCount;++i) {
+        const size_t skip=i==first?offset:0;
+        visit(count++, chunks[i].Data()+skip, chunks[i].Size()-skip);
+    }
+    return count;
+}
+
+inline void SendQueue::Push(const char* data, const size_t len, const SharedPayload* shared) {
+    if (len==0) return;
+    bytes+=len;
+
+    // 小负载同样只引用：拷贝需要为每个连接申请数据块，比增加引用计数更慢
+    if (shared!=nullptr) {
+        chunks.push_back(Chunk{std::string(), *shared, data, len});
+        ++sharedCount;
+        return;
+    }
+
+    if (first<chunks.size()&&!chunks.back().shared&&chunks.back().owned.size()+len<=COALESCE_SIZE)
+        chunks.back().owned.append(data, len);
+    else chunks.push_back(Chunk{std::string(data, len)});
+}
+
+inline void SendQueue::Push(std::string&& data) {
+    if (data.size()<COALESCE_SIZE) {
+        Push(data.data(), data.size());
+        return;
+    }
+
+    bytes+=data.size();
+    chunks.push_back(Chunk{std::move(data)});
+}
+
+inline void SendQueue::Consume(size_t len) {
+    len=std::min(len, bytes);
+    bytes-=len;
+
+    while (len>0) {
+        const size_t available=chunks[first].Size()-offset;
+        if (len<available) {
+            offset+=len;
+            return;
+        }
+        len-=available;
+        PopFront();
+    }
+}
+
+inline size_t SendQueue::CopyTo(char* buffer, const size_t len) {
+    size_t copied=0;
+    while (copied<len&&first<chunks.size()) {
+        const Chunk& chunk=chunks[first];
+        const size_t take=std::min(len-copied, chunk.Size()-offset);
+        memcpy(buffer+copied, chunk.Data()+offset, take);
+        copied+=take;
+        offset+=take;
+        bytes-=take;
+        if (offset==chunk.Size()) PopFront();
+    }
+    return copied;
+}
+
+inline void SendQueue::MoveTo(SendQueue& other, const unsigned maxCount, const size_t maxBytes) {
+    size_t moved=0;
+    for (unsigned count=0;count<maxCount&&moved<maxBytes&&first<chunks.size();++count) {
+        Chunk& chunk=chunks[first];
+        if (offset>0) {
+            if (chunk.shared) {
+                chunk.view+=offset;
+                chunk.viewSize-=offset;
+            }
+            else chunk.owned.erase(0, offset);
+        }
+
+        if (chunk.shared) {
+            --sharedCount;
+            ++other.sharedCount;
+        }
+
+        const size_t size=chunk.Size();
+        moved+=size;
+        bytes-=size;
+        other.bytes+=size;
+        other.chunks.push_back(std::move(chunk));
+        PopFront();
+    }
+}
+
+inline void SendQueue::Clear() {
+    chunks.clear();
+    first=offset=bytes=sharedCount=0;
+}
+
+inline void SendQueue::PopFront() {
+    if (chunks[first].shared) --sharedCount;
+    chunks[first++]=Chunk(); // 释放已写完数据块的内存和共享负载的引用
+    offset=0;
+
+    if (first==chunks.size()) {
+        chunks.clear();
+        first=0;
+    }
+    else if (first>=COMPACT_COUNT&&first*2>=chunks.size()) {
+        chunks.erase(chunks.begin(), chunks.begin()+static_cast<std::ptrdiff_t>(first));
+        first=0;
+    }
+}
+
+#endif //SENDQUEUE_H
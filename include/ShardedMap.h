@@ -0,0 +1,124 @@
+#ifndef SHARDEDMAP_H
+#define SHARDEDMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// 按键哈希分片的并发哈希表，每个分片独立加读写锁
+// 查找只持有所在分片的读锁，不同分片上的插入、删除互不阻塞
+template<class K, class V, unsigned Shards=64>
+class ShardedMap {
+    static_assert(Shards>0&&(Shards&(Shards-1))==0, "Shards must be a power of two");
+
+    public:
+        ShardedMap()=default;
+        ShardedMap(const ShardedMap&)=delete;
+        ShardedMap& operator=(const ShardedMap&)=delete;
+
+        void Insert(const K& key, const V& value); // 已存在时覆盖
+        bool Erase(const K& key, V* removed=nullptr);
+        bool Find(const K& key, V& value)const; // 拷贝出值
+
+        // 持有分片读锁调用f(V&)，f返回前对应的删除会被阻塞
+        template<class F>
+        bool Visit(const K& key, F&& f);
+        // 依次持有每个分片的读锁调用f(const K&, V&)，不会同时锁住多个分片
+        template<class F>
+        void ForEach(F&& f);
+
+        [[nodiscard]] size_t Size()const;
+
+    private:
+        struct alignas(64) Shard {
+            mutable std::shared_mutex lock;
+            std::unordered_map<K, V> map;
+        };
+
+        static size_t Index(const K& key);
+        static constexpr unsigned ShardBits() {
+            unsigned bits=0;
+            while ((1u<<bits)<Shards) ++bits;
+            return bits;
+        }
+
+    private:
+        Shard shards[Shards];
+};
+
+template<class K, class V, unsigned Shards>
+void ShardedMap<K, V, Shards>::Insert(const K& key, const V& value) {
+    Shard& shard=shards[Index(key)];
+    std::unique_lock lock(shard.lock);
+    shard.map[key]=value;
+}
+
+template<class K, class V, unsigned Shards>
+bool ShardedMap<K, V, Shards>::Erase(const K& key, V* removed) {
+    Shard& shard=shards[Index(key)];
+    std::unique_lock lock(shard.lock);
+
+    auto it=shard.map.find(key);
+    if (it==shard.map.end()) return false;
+    if (removed!=nullptr) *removed=std::move(it->second);
+    shard.map.erase(it);
+    return true;
+}
+
+template<class K, class V, unsigned Shards>
+bool ShardedMap<K, V, Shards>::Find(const K& key, V& value)const {
+    const Shard& shard=shards[Index(key)];
+    std::shared_lock lock(shard.lock);
+
+    auto it=shard.map.find(key);
+    if (it==shard.map.end()) return false;
+    value=it->second;
+    return true;
+}
+
+template<class K, class V, unsigned Shards>
+template<class F>
+bool ShardedMap<K, V, Shards>::Visit(const K& key, F&& f) {
+    Shard& shard=shards[Index(key)];
+    std::shared_lock lock(shard.lock);
+
+    auto it=shard.map.find(key);
+    if (it==shard.map.end()) return false;
+    f(it->second);
+    return true;
+}
+
+template<class K, class V, unsigned Shards>
+template<class F>
+void ShardedMap<K, V, Shards>::ForEach(F&& f) {
+    for (Shard& shard : shards) {
+        std::shared_lock lock(shard.lock);
+        for (auto& [key, value] : shard.map)
+            f(key, value);
+    }
+}
+
+template<class K, class V, unsigned Shards>
+size_t ShardedMap<K, V, Shards>::Size()const {
+    size_t size=0;
+    for (const Shard& shard : shards) {
+        std::shared_lock lock(shard.lock);
+        size+=shard.map.size();
+    }
+    return size;
+}
+
+template<class K, class V, unsigned Shards>
+size_t ShardedMap<K, V, Shards>::Index(const K& key) {
+    // 斐波那契散列取高位，连续的ID和按4对齐的句柄值都能均匀分布
+    if constexpr (Shards==1) return 0;
+    else {
+        const uint64_t hash=static_cast<uint64_t>(std::hash<K>{}(key))*0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash>>(64-ShardBits()));
+    }
+}
+
+#endif //SHARDEDMAP_H
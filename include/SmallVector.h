@@ -0,0 +1,42 @@
+#ifndef SMALLVECTOR_H_
+#define SMALLVECTOR_H_
+
+#include "Vector.h"
+
+namespace SmallVectorDetail{
+    // 作为第一个基类，保证内联存储先于Vector构造、后于Vector析构
+    template<class T, ui N>
+    struct InlineStorage{
+        T* Buffer(){return reinterpret_cast<T*>(buffer);}
+
+        alignas(T) unsigned char buffer[N*sizeof(T)];
+    };
+}
+
+// 前N个元素存放在对象内部，超过N个才申请堆内存，之后的行为与Vector相同
+// 接口与Vector一致，也可以作为Vector<T>&传给只接受Vector的函数
+template<class T, ui N>
+class SmallVector:private SmallVectorDetail::InlineStorage<T, N>, public Vector<T>{
+    static_assert(N>0, "SmallVector needs at least one inline element");
+
+    using Storage=SmallVectorDetail::InlineStorage<T, N>;
+
+    public:
+        typedef typename Vector<T>::iterator iterator;
+
+        SmallVector():Vector<T>(Storage::Buffer(), N){}
+        explicit SmallVector(ui size, const T& val=T()):SmallVector(){this->Assign(size, val);}
+        explicit SmallVector(int size, const T& val=T()):SmallVector(static_cast<ui>(size), val){}
+        SmallVector(iterator _start, iterator _end):SmallVector(){this->Assign(_start, _end);}
+        SmallVector(const SmallVector& x):SmallVector(){this->Assign(x.begin(), x.end());}
+        // 自身容量至少为N，x在内联存储中时不会申请内存，只有元素的移动可能抛出异常
+        SmallVector(SmallVector&& x)noexcept(std::is_nothrow_move_constructible_v<T>):SmallVector(){Vector<T>::operator=(std::move(x));}
+
+        SmallVector& operator=(const SmallVector& x){Vector<T>::operator=(x);return *this;}
+        SmallVector& operator=(SmallVector&& x)noexcept(std::is_nothrow_move_constructible_v<T>){Vector<T>::operator=(std::move(x));return *this;}
+
+        using Vector<T>::Capacity;
+        [[nodiscard]] bool IsInline()const{return this->cbegin()==reinterpret_cast<const T*>(Storage::buffer);} // 元素是否仍在内联存储中
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 只可移动的类型擦除可调用对象
+// 不超过INLINE_SIZE字节、且移动不抛异常的可调用对象直接存放在内部缓冲区，不申请堆内存；更大的对象退化为堆上存储
+class Task {
+    public:
+        static constexpr size_t INLINE_SIZE=56; // 与ops指针合计64字节，占一条缓存行
+
+        Task()=default;
+        template<class F, class=std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+        Task(F&& f);
+        Task(Task&& other) noexcept;
+        Task& operator=(Task&& other) noexcept;
+        Task(const Task&)=delete;
+        Task& operator=(const Task&)=delete;
+        ~Task() {Reset();}
+
+        void operator()() {ops->invoke(storage);}
+        explicit operator bool()const {return ops!=nullptr;}
+        void Reset();
+
+        template<class F>
+        static constexpr bool IsInline=sizeof(F)<=INLINE_SIZE&&alignof(F)<=alignof(void*)&&std::is_nothrow_move_constructible_v<F>;
+
+    private:
+        struct Ops {
+            void (*invoke)(void* storage);
+            void (*move)(void* dst, void* src) noexcept; // 移动构造到dst并析构src
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template<class F>
+        static const Ops inlineOps;
+        template<class F>
+        static const Ops heapOps;
+
+    private:
+        alignas(void*) unsigned char storage[INLINE_SIZE];
+        const Ops* ops=nullptr;
+};
+
+template<class F>
+const Task::Ops Task::inlineOps={
+    [](void* storage) {(*static_cast<F*>(storage))();},
+    [](void* dst, void* src) noexcept {
+        F* f=static_cast<F*>(src);
+        ::new(dst) F(std::move(*f));
+        f->~F();
+    },
+    [](void* storage) noexcept {static_cast<F*>(storage)->~F();}
+};
+
+template<class F>
+const Task::Ops Task::heapOps={
+    [](void* storage) {(**static_cast<F**>(storage))();},
+    [](void* dst, void* src) noexcept {::new(dst) F*(*static_cast<F**>(src));},
+    [](void* storage) noexcept {delete *static_cast<F**>(storage);}
+};
+
+template<class F, class>
+Task::Task(F&& f) {
+    using T=std::decay_t<F>;
+    if constexpr (IsInline<T>) {
+        ::new(storage) T(std::forward<F>(f));
+        ops=&inlineOps<T>;
+    }
+    else {
+        ::new(storage) T*(new T(std::forward<F>(f)));
+        ops=&heapOps<T>;
+    }
+}
+
+inline Task::Task(Task&& other) noexcept {
+    if (other.ops!=nullptr) {
+        other.ops->move(storage, other.storage);
+        ops=other.ops;
+        other.ops=nullptr;
+    }
+}
+
+inline Task& Task::operator=(Task&& other) noexcept {
+    if (this!=&other) {
+        Reset();
+        if (other.ops!=nullptr) {
+            other.ops->move(storage, other.storage);
+            ops=other.ops;
+            other.ops=nullptr;
+        }
+    }
+    return *this;
+}
+
+inline void Task::Reset() {
+    if (ops!=nullptr) {
+        ops->destroy(storage);
+        ops=nullptr;
+    }
+}
+
+#endif //TASK_H
@@ -1,17 +1,28 @@
 #ifndef VECTOR_H_
 #define VECTOR_H_
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 typedef unsigned int ui;
 
+template<class T, ui N>
+class SmallVector;
+
 template<class T>
-void inline swap(T& a, T& b)noexcept{
-    T c=a;
-    a=b;
-    b=c;
+void inline swap(T& a, T& b)noexcept(std::is_nothrow_move_constructible_v<T>&&std::is_nothrow_move_assignable_v<T>){
+    T c=std::move(a);
+    a=std::move(b);
+    b=std::move(c);
 }
 
+// 元素构造在未初始化的存储中，不要求T可默认构造
+// 扩容时移动元素，可平凡复制的类型直接memcpy/memmove；删除元素不会缩容，需要时显式调用ShrinkToFit
 template<class T>
 class Vector{
     public:
@@ -40,60 +51,80 @@ class Vector{
             Vector<T>::iterator rIt;
         };
 
-        Vector():Vector(1){IsInit=true;};
-        explicit Vector(ui size, T val=T());
-        explicit Vector(int size, T val=T());
+        Vector()=default;
+        explicit Vector(ui size, const T& val=T());
+        explicit Vector(int size, const T& val=T());
         Vector(iterator _start, iterator _end);
         Vector(const Vector<T>& x);
-        Vector(Vector<T>&& x)noexcept;
+        Vector(Vector<T>&& x)noexcept; // x应为普通Vector，在堆上时才能直接接管
+        template<ui N>
+        Vector(SmallVector<T, N>&& x); // x可能在内联存储中，需要申请内存逐个移动，可能抛出异常
         ~Vector();
 
         Vector<T>& operator=(const Vector<T>& x);
         Vector<T>& operator=(Vector<T>&& x)noexcept;
+        template<ui N>
+        Vector<T>& operator=(SmallVector<T, N>&& x);
         T& operator[](ui pos);
         const T& operator[](ui pos)const;
 
         [[nodiscard]] ui Size()const;
         [[nodiscard]] bool Empty();
         [[nodiscard]] bool Empty()const;
-        void Clear();
+        void Clear(); // 析构所有元素，保留容量
         const iterator& EOS()const;
         const iterator& cbegin()const;
         const iterator& cend()const;
         const iterator& begin()const;
         const iterator& end()const;
-        const reverseIterator& crbegin()const;
-        const reverseIterator& crend()const;
+        reverseIterator crbegin()const;
+        reverseIterator crend()const;
         iterator& begin();
         iterator& end();
-        reverseIterator& rbegin();
-        reverseIterator& rend();
+        reverseIterator rbegin();
+        reverseIterator rend();
         T& Front();
         T& Back();
 
         void Assign(ui size, const T& val);
         void Assign(iterator _start, iterator _end);
         void PushBack(const T& val);
+        void PushBack(T&& val);
+        template<class... Args>
+        T& EmplaceBack(Args&&... args); // 在末尾原地构造
         void PopBack();
         iterator Insert(ui pos, const T& val);
+        iterator Insert(ui pos, T&& val);
         iterator Insert(iterator p, const T& val);
+        iterator Insert(iterator p, T&& val);
+        template<class... Args>
+        iterator Emplace(iterator p, Args&&... args); // 在p处原地构造，返回新元素的位置
         iterator Erase(iterator p);
         iterator Erase(ui pos, ui size=1);
 
         void ShrinkToFit();
-        void Reserse(ui size);
+        void Reserve(ui size);
+        void Reserse(ui size){Reserve(size);} // 旧拼写
         void Resize(ui size, const T& val=T());
 
     protected:
+        Vector(iterator buffer, ui capacity); // 使用外部提供的内联存储，供SmallVector使用
         [[nodiscard]] ui Capacity()const;
 
     private:
-        bool IsInit;
-        iterator Start;
-        iterator Finish;
-        iterator EndOfStorage;
-        reverseIterator Rstart;
-        reverseIterator Rfinish;
+        static void Relocate(T* dst, T* src, ui count); // 把count个元素移动到未初始化的dst并析构原元素
+        void Reallocate(ui capacity); // 换到容量为capacity的新存储
+        void Deallocate(); // 释放堆上的存储，内联存储不释放
+        void MoveFrom(Vector<T>& x); // 调用方需保证自身为空；x在堆上时直接接管，在内联存储中时逐个移动，容量不足时需要申请内存
+        [[nodiscard]] ui NextCapacity()const{return Size()==0?2:Size()*2;}
+
+    private:
+        std::allocator<T> allocator;
+        iterator Start=nullptr;
+        iterator Finish=nullptr;
+        iterator EndOfStorage=nullptr;
+        iterator InlineStart=nullptr; // 内联存储，普通Vector为nullptr
+        ui InlineCapacity=0;
 };
 
 template<typename iterator>
@@ -105,83 +136,63 @@ void Reverse(iterator first, iterator last){
 }
 
 template<class T>
-Vector<T>::Vector(ui size, const T val){
-    IsInit=false;
-    Start=new T[size];
+Vector<T>::Vector(const ui size, const T& val){
+    Reserve(size);
+    std::uninitialized_fill_n(Start, size, val);
     Finish=Start+size;
-    Rstart=Finish-1;
-    Rfinish=Start-1;
-    EndOfStorage=Start+size;
-    for(int i=0;i<size;i++)
-        Start[i]=val;
 }
 
 template<class T>
-Vector<T>::Vector(int size, const T val){
-    IsInit=false;
-    Start=new T[size];
-    Finish=Start+size;
-    Rstart=Finish-1;
-    Rfinish=Start-1;
-    EndOfStorage=Start+size;
-    for(int i=0;i<size;i++)
-        Start[i]=val;
-}
+Vector<T>::Vector(const int size, const T& val):Vector(static_cast<ui>(size), val){}
 
 template<class T>
 Vector<T>::Vector(const iterator _start, const iterator _end){
-    IsInit=false;
-    while(_start!=_end){
-        PushBack(*_start);
-        ++_start;
-    }
-    Rstart=Finish-1;
-    Rfinish=Start-1;
+    Assign(_start, _end);
 }
 
 template<class T>
 Vector<T>::Vector(const Vector<T>& x){
-    IsInit=false;
-    Start=new T[x.Capacity()];
-    for(int i=0, len=x.Size();i<len;i++)
-        Start[i]=x[i];
-    Finish=Start+x.Size();
-    Rstart=Finish-1;
-    Rfinish=Start-1;
-    EndOfStorage=Start+x.Capacity();
+    Reserve(x.Size());
+    Finish=std::uninitialized_copy(x.Start, x.Finish, Start);
 }
 
 template<class T>
 Vector<T>::Vector(Vector<T>&& x)noexcept{
-    IsInit=false;
-    this->Start=x.Start;x.Start=nullptr;
-    this->Finish=x.Finish;x.Finish=nullptr;
-    this->EndOfStorage=x.EndOfStorage;x.EndOfStorage=nullptr;
-    this->Rstart=x.Rstart;x.Rstart=nullptr;
-    this->Rfinish=x.Rfinish;x.Rfinish=nullptr;
+    MoveFrom(x);
 }
 
+template<class T>
+template<ui N>
+Vector<T>::Vector(SmallVector<T, N>&& x){
+    MoveFrom(x);
+}
+
+template<class T>
+Vector<T>::Vector(const iterator buffer, const ui capacity):Start(buffer), Finish(buffer), EndOfStorage(buffer+capacity), InlineStart(buffer), InlineCapacity(capacity){}
+
 template <class T>
 Vector<T>& Vector<T>::operator=(const Vector<T>& x){
-    IsInit=false;
-    Start=new T[x.Capacity()];
-    for(int i=0, len=x.Size();i<len;i++)
-        Start[i]=x[i];
-    Finish=Start+x.Size();
-    Rstart=Finish-1;
-    Rfinish=Start-1;
-    EndOfStorage=Start+x.Capacity();
+    if(this!=&x)Assign(x.Start, x.Finish);
     return *this;
 }
 
 template <class T>
 Vector<T>& Vector<T>::operator=(Vector<T>&& x)noexcept{
-    IsInit=false;
-    this->Start=x.Start;x.Start=nullptr;
-    this->Finish=x.Finish;x.Finish=nullptr;
-    this->EndOfStorage=x.EndOfStorage;x.EndOfStorage=nullptr;
-    this->Rstart=x.Rstart;x.Rstart=nullptr;
-    this->Rfinish=x.Rfinish;x.Rfinish=nullptr;
+    if(this!=&x){
+        Clear();
+        MoveFrom(x);
+    }
+    return *this;
+}
+
+template<class T>
+template<ui N>
+Vector<T>& Vector<T>::operator=(SmallVector<T, N>&& x){
+    Vector<T>& source=x;
+    if(this!=&source){
+        Clear();
+        MoveFrom(source);
+    }
     return *this;
 }
 
@@ -199,7 +210,8 @@ const T& Vector<T>::operator[](ui pos)const{
 
 template<class T>
 Vector<T>::~Vector(){
-    if(Start!=nullptr)delete []Start;
+    Clear();
+    Deallocate();
     Start=Finish=EndOfStorage=nullptr;
 }
 
@@ -220,8 +232,8 @@ bool Vector<T>::Empty()const{
 
 template<class T>
 void Vector<T>::Clear(){
+    std::destroy(Start, Finish);
     Finish=Start;
-    Rfinish=Rstart;
 }
 
 template<class T>
@@ -250,13 +262,13 @@ const typename Vector<T>::iterator& Vector<T>::end()const{
 }
 
 template<class T>
-const typename Vector<T>::reverseIterator& Vector<T>::crbegin()const{
-    return Rstart;
+typename Vector<T>::reverseIterator Vector<T>::crbegin()const{
+    return Finish-1;
 }
 
 template<class T>
-const typename Vector<T>::reverseIterator& Vector<T>::crend()const{
-    return Rfinish;
+typename Vector<T>::reverseIterator Vector<T>::crend()const{
+    return Start-1;
 }
 
 template<class T>
@@ -270,55 +282,107 @@ typename Vector<T>::iterator& Vector<T>::end(){
 }
 
 template<class T>
-typename Vector<T>::reverseIterator& Vector<T>::rbegin(){
-    return Rstart;
+typename Vector<T>::reverseIterator Vector<T>::rbegin(){
+    return Finish-1;
 }
 
 template<class T>
-typename Vector<T>::reverseIterator& Vector<T>::rend(){
-    return Rfinish;
+typename Vector<T>::reverseIterator Vector<T>::rend(){
+    return Start-1;
 }
 
 template<class T>
 T& Vector<T>::Front(){
-    assert(Start);
+    assert(!Empty());
     return *Start;
 }
 
 template<class T>
 T& Vector<T>::Back(){
-    assert(Finish-1);
+    assert(!Empty());
     return *(Finish-1);
 }
 
 template<class T>
 void Vector<T>::Assign(const ui size, const T& val){
-    for(int i=0;i<size;i++)    
-        *(Start+i)=val;
+    if(size>Capacity()){
+        Vector<T> tmp(size, val);
+        *this=std::move(tmp);
+        return;
+    }
+    const ui common=std::min(size, Size());
+    std::fill_n(Start, common, val);
+    if(size>Size())std::uninitialized_fill_n(Finish, size-common, val);
+    else std::destroy(Start+size, Finish);
+    Finish=Start+size;
 }
 
 template<class T>
 void Vector<T>::Assign(Vector<T>::iterator _start, Vector<T>::iterator _end){
-    ui new_size=_end-_start;
-    if(new_size>this->Size())
-        this->Resize(new_size);
-    for(ui i=0;i<new_size;i++)
-        *(Start+i)=*(_start+i);
+    const ui newSize=_end-_start;
+    if(newSize>Capacity()){
+        // 区间可能指向自身，先复制到新存储再释放旧存储
+        T* tmp=allocator.allocate(newSize);
+        try{
+            std::uninitialized_copy(_start, _end, tmp);
+        }
+        catch(...){
+            allocator.deallocate(tmp, newSize);
+            throw;
+        }
+        Clear();
+        Deallocate();
+        Start=tmp;
+        Finish=EndOfStorage=Start+newSize;
+        return;
+    }
+    const ui common=std::min(newSize, Size());
+    std::copy(_start, _start+common, Start);
+    if(newSize>Size())std::uninitialized_copy(_start+common, _end, Finish);
+    else std::destroy(Start+newSize, Finish);
+    Finish=Start+newSize;
 }
 
 template<class T>
 void Vector<T>::PushBack(const T& val){
-    if(IsInit){
-        IsInit=false;
-        Clear();
+    EmplaceBack(val);
+}
+
+template<class T>
+void Vector<T>::PushBack(T&& val){
+    EmplaceBack(std::move(val));
+}
+
+template<class T>
+template<class... Args>
+T& Vector<T>::EmplaceBack(Args&&... args){
+    if(Finish==EndOfStorage){
+        // 先在新存储中构造新元素，args可能引用旧存储中的元素
+        const ui oldSize=Size();
+        const ui capacity=NextCapacity();
+        T* tmp=allocator.allocate(capacity);
+        try{
+            ::new(static_cast<void*>(tmp+oldSize)) T(std::forward<Args>(args)...);
+        }
+        catch(...){
+            allocator.deallocate(tmp, capacity);
+            throw;
+        }
+        Relocate(tmp, Start, oldSize);
+        Deallocate();
+        Start=tmp;
+        Finish=Start+oldSize;
+        EndOfStorage=Start+capacity;
     }
-    Insert(end(), val);
+    else ::new(static_cast<void*>(Finish)) T(std::forward<Args>(args)...);
+    return *Finish++;
 }
 
 template<class T>
 void Vector<T>::PopBack(){
     assert(Size());
-    Erase(end()-1);
+    --Finish;
+    std::destroy_at(Finish);
 }
 
 template<class T>
@@ -326,28 +390,66 @@ typename Vector<T>::iterator Vector<T>::Insert(const ui pos, const T& val){
 	return this->Insert(Start+pos, val);
 }
 
+template<class T>
+typename Vector<T>::iterator Vector<T>::Insert(const ui pos, T&& val){
+    return this->Insert(Start+pos, std::move(val));
+}
+
 template<class T>
 typename Vector<T>::iterator Vector<T>::Insert(iterator p, const T& val){
+    return Emplace(p, val)+1;
+}
+
+template<class T>
+typename Vector<T>::iterator Vector<T>::Insert(iterator p, T&& val){
+    return Emplace(p, std::move(val))+1;
+}
+
+template<class T>
+template<class... Args>
+typename Vector<T>::iterator Vector<T>::Emplace(iterator p, Args&&... args){
     assert(p>=Start);
     assert(p<=Finish);
 
+    const ui pos=p-Start;
     if(Finish==EndOfStorage){
-        ui len=Size();
-        ui pos=p-Start;
-        if(len==0)len=2;
-        Reserse(len*2);
-        p=Start+pos;
+        // 新元素直接构造到新存储的pos处，前后两段分别搬过去
+        const ui oldSize=Size();
+        const ui capacity=NextCapacity();
+        T* tmp=allocator.allocate(capacity);
+        try{
+            ::new(static_cast<void*>(tmp+pos)) T(std::forward<Args>(args)...);
+        }
+        catch(...){
+            allocator.deallocate(tmp, capacity);
+            throw;
+        }
+        Relocate(tmp, Start, pos);
+        Relocate(tmp+pos+1, Start+pos, oldSize-pos);
+        Deallocate();
+        Start=tmp;
+        Finish=Start+oldSize+1;
+        EndOfStorage=Start+capacity;
+        return Start+pos;
     }
-    iterator end=Finish-1;
-    while(end>=p){
-        *(end+1)=*end;
-        --end;
+    if(p==Finish){
+        ::new(static_cast<void*>(Finish)) T(std::forward<Args>(args)...);
+        ++Finish;
+        return p;
     }
-    *p=val;
-    ++Finish;
-    Rstart=Finish-1;
 
-    return p+1;
+    T val(std::forward<Args>(args)...); // args可能引用即将被移动的元素
+    if constexpr(std::is_trivially_copyable_v<T>){
+        memmove(static_cast<void*>(p+1), p, (Finish-p)*sizeof(T));
+        ::new(static_cast<void*>(p)) T(std::move(val));
+    }
+    else{
+        ::new(static_cast<void*>(Finish)) T(std::move(*(Finish-1)));
+        std::move_backward(p, Finish-1, Finish);
+        *p=std::move(val);
+    }
+    ++Finish;
+    return p;
 }
 
 template<class T>
@@ -355,82 +457,63 @@ typename Vector<T>::iterator Vector<T>::Erase(iterator p){
     assert(p>=Start);
     assert(p<Finish);
 
-    iterator pos=p;
-    while(pos<Finish){
-        *pos=*(pos+1);
-        ++pos;
-    }
-    --Finish;
-    Rstart=Finish-1;
-
-    return p;
+    return Erase(p-Start, 1);
 }
 
 template<class T>
 typename Vector<T>::iterator Vector<T>::Erase(const ui pos, const ui size){
     assert(pos+size<=this->Size());
 
-    for(ui p=pos+size, len=this->Size();p<len;p++)
-        Start[p-size]=Start[p];
+    iterator first=Start+pos;
+    if constexpr(std::is_trivially_copyable_v<T>){
+        memmove(static_cast<void*>(first), first+size, (Finish-first-size)*sizeof(T));
+    }
+    else{
+        std::move(first+size, Finish, first);
+        std::destroy(Finish-size, Finish);
+    }
     this->Finish-=size;
-    this->Rstart=this->Finish-1;
-    this->ShrinkToFit();
 
-    return Start+pos;
+    return first;
 }
 
 template<class T>
 void Vector<T>::ShrinkToFit(){
     if(Finish==EndOfStorage)return;
-    Reserse(Size());
+    Reallocate(Size());
 }
 
 template<class T>
-void Vector<T>::Reserse(ui size){
-    if(size>Capacity()){
-        ui oldSize=Size();
-        T* tmp=new T[size];
-        if(Start!=nullptr){
-            for(int i=0;i<oldSize;i++)
-                tmp[i]=Start[i];
-            delete []Start;
-        }
-        Start=tmp;
-        Finish=Start+oldSize;
-        Rstart=Finish-1;
-        Rfinish=Start-1;
-        EndOfStorage=Start+size;
-    }
+void Vector<T>::Reserve(const ui size){
+    if(size>Capacity())Reallocate(size);
 }
 
 template<class T>
-void Vector<T>::Resize(ui size, const T& val){
-    if(size<Size())Finish=Start+size;
-    else {
-        if(size<=Capacity()){
-            while(Finish!=EndOfStorage){
-                *Finish=val;
-                ++Finish;
+void Vector<T>::Resize(const ui size, const T& val){
+    if(size<Size()){
+        std::destroy(Start+size, Finish);
+        Finish=Start+size;
+    }
+    else if(size>Size()){
+        if(size>Capacity()){
+            // 先在新存储中填充，val可能引用旧存储中的元素
+            const ui oldSize=Size();
+            T* tmp=allocator.allocate(size);
+            try{
+                std::uninitialized_fill(tmp+oldSize, tmp+size, val);
             }
-        }
-        else {
-            ui oldSize=Size();
-            T* tmp=new T[size];
-            for(ui i=0, len=Size();i<len;i++)
-                tmp[i]=Start[i];
-            delete []Start;
+            catch(...){
+                allocator.deallocate(tmp, size);
+                throw;
+            }
+            Relocate(tmp, Start, oldSize);
+            Deallocate();
             Start=tmp;
-            Finish=Start+oldSize;
             EndOfStorage=Start+size;
-            while(Finish!=EndOfStorage){
-                *Finish=val;
-                ++Finish;
-            }
         }
+        else std::uninitialized_fill(Finish, Start+size, val);
+        Finish=Start+size;
     }
-    Rstart=Finish-1;
-    Rfinish=Start-1;
-    IsInit=false;
 }
 
 template<class T>
@@ -438,4 +521,58 @@ ui Vector<T>::Capacity()const{
     return EndOfStorage-Start;
 }
 
+template<class T>
+void Vector<T>::Relocate(T* dst, T* src, const ui count){
+    if(count==0)return;
+    if constexpr(std::is_trivially_copyable_v<T>){
+        memcpy(static_cast<void*>(dst), src, count*sizeof(T));
+    }
+    else{
+        for(ui i=0;i<count;i++){
+            ::new(static_cast<void*>(dst+i)) T(std::move_if_noexcept(src[i]));
+            std::destroy_at(src+i);
+        }
+    }
+}
+
+template<class T>
+void Vector<T>::Reallocate(ui capacity){
+    const ui oldSize=Size();
+    T* tmp;
+    if(InlineStart!=nullptr&&capacity<=InlineCapacity){ // 放得下时回到内联存储
+        if(Start==InlineStart)return;
+        tmp=InlineStart;
+        capacity=InlineCapacity;
+    }
+    else tmp=capacity>0?allocator.allocate(capacity):nullptr;
+    Relocate(tmp, Start, oldSize);
+    Deallocate();
+    Start=tmp;
+    Finish=Start+oldSize;
+    EndOfStorage=Start+capacity;
+}
+
+template<class T>
+void Vector<T>::Deallocate(){
+    if(Start!=nullptr&&Start!=InlineStart)allocator.deallocate(Start, Capacity());
+}
+
+template<class T>
+void Vector<T>::MoveFrom(Vector<T>& x){
+    if(x.Start!=x.InlineStart){
+        Deallocate();
+        Start=x.Start;
+        Finish=x.Finish;
+        EndOfStorage=x.EndOfStorage;
+        x.Start=x.Finish=x.EndOfStorage=x.InlineStart;
+        if(x.InlineStart!=nullptr)x.EndOfStorage+=x.InlineCapacity;
+    }
+    else{
+        Reserve(x.Size());
+        Relocate(Start, x.Start, x.Size());
+        Finish=Start+x.Size();
+        x.Finish=x.Start;
+    }
+}
+
 #endif
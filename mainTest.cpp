@@ -1,4 +1,8 @@
+#ifdef _WIN32
 #include "MyWindowX.h"
+#else
+#include "MyLogger.h"
+#endif
 
 std::shared_ptr<MyLogger> logger(nullptr, MyLogger::Deleter());
 
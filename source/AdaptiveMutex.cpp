@@ -0,0 +1,43 @@
+#include "AdaptiveMutex.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <thread>
+#endif
+
+void FutexWait(std::atomic<uint32_t>* address, uint32_t expected, const long long timeoutMicros) {
+#ifdef _WIN32
+    const DWORD timeout=timeoutMicros<0?INFINITE:static_cast<DWORD>((timeoutMicros+999)/1000);
+    WaitOnAddress(address, &expected, sizeof(expected), timeout);
+#elif defined(__linux__)
+    timespec timeout{};
+    if (timeoutMicros>=0) {
+        timeout.tv_sec=static_cast<time_t>(timeoutMicros/1000000);
+        timeout.tv_nsec=static_cast<long>(timeoutMicros%1000000*1000);
+    }
+    // std::atomic<uint32_t>与uint32_t布局相同，内核只比较地址上的值
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT_PRIVATE, expected, timeoutMicros<0?nullptr:&timeout, nullptr, 0);
+#else
+    (void)timeoutMicros;
+    if (address->load(std::memory_order_relaxed)==expected) std::this_thread::yield();
+#endif
+}
+
+void FutexWake(std::atomic<uint32_t>* address, const bool all) {
+#ifdef _WIN32
+    if (all) WakeByAddressAll(address);
+    else WakeByAddressSingle(address);
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE_PRIVATE, all?INT_MAX:1, nullptr, nullptr, 0);
+#else
+    (void)address;
+    (void)all;
+#endif
+}
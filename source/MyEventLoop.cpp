@@ -0,0 +1,108 @@
+#include "MyEventLoop.h"
+
+#include <algorithm>
+
+std::unique_ptr<MyEventLoop> MyEventLoop::Create(EventLoopType type, [[maybe_unused]] const bool perThread) {
+    std::unique_ptr<MyEventLoop> loop;
+
+#ifdef _WIN32
+    if (type==EventLoopType::Auto||type==EventLoopType::IOCP)
+        loop=CreateIOCPLoop(!perThread);
+#endif
+
+#ifdef __linux__
+    if (type==EventLoopType::Auto||type==EventLoopType::IoUring) {
+        loop=CreateUringLoop();
+        if (loop->Open()) return loop;
+        type=EventLoopType::Epoll; // 内核不支持io_uring时回退到epoll
+    }
+    if (type==EventLoopType::Epoll)
+        loop=CreateEpollLoop();
+#endif
+
+    if (loop==nullptr||!loop->Open()) return nullptr; // 当前平台不支持该后端
+    return loop;
+}
+
+bool MyEventLoop::Post(std::function<void()> task) {
+    if (closed.load(std::memory_order_acquire)) return false;
+    if (Shared()) {
+        task();
+        return true;
+    }
+
+    // 与Close并发时任务可能入队后不再执行，随循环析构时销毁
+    tasks.Push(std::move(task));
+    if (!wakePending.exchange(true, std::memory_order_acq_rel)) Wake();
+    return true;
+}
+
+void MyEventLoop::RunTasks() {
+    if (!wakePending.load(std::memory_order_acquire)) return;
+    wakePending.store(false, std::memory_order_release);
+
+    std::function<void()> task;
+    while (tasks.Pop(task))
+        task();
+}
+
+void MyEventLoop::AddMember(const MySocketX::LPPER_HANDLE_DATA handleData) {
+    std::lock_guard lock(memberLock);
+    handleData->memberIndex=members.size();
+    members.push_back(handleData);
+}
+
+void MyEventLoop::RemoveMember(const MySocketX::LPPER_HANDLE_DATA handleData) {
+    std::lock_guard lock(memberLock);
+
+    for (const auto& group : handleData->groups) {
+        auto it=groups.find(group);
+        if (it==groups.end()) continue;
+        it->second.erase(handleData);
+        if (it->second.empty()) groups.erase(it);
+    }
+    handleData->groups.Clear();
+
+    // 与末尾元素交换后删除
+    const size_t index=handleData->memberIndex;
+    if (index>=members.size()||members[index]!=handleData) return;
+    members[index]=members.back();
+    members[index]->memberIndex=index;
+    members.pop_back();
+}
+
+bool MyEventLoop::Join(const MySocketX::LPPER_HANDLE_DATA handleData, const std::string& group) {
+    std::lock_guard lock(memberLock);
+    if (!groups[group].insert(handleData).second) return false;
+    handleData->groups.PushBack(group);
+    return true;
+}
+
+bool MyEventLoop::Leave(const MySocketX::LPPER_HANDLE_DATA handleData, const std::string& group) {
+    std::lock_guard lock(memberLock);
+
+    auto it=groups.find(group);
+    if (it==groups.end()||it->second.erase(handleData)==0) return false;
+    if (it->second.empty()) groups.erase(it);
+
+    auto& joined=handleData->groups;
+    joined.Erase(std::find(joined.begin(), joined.end(), group));
+    return true;
+}
+
+ui MyEventLoop::FanOut(const SharedPayload& payload, const std::string& group) {
+    std::lock_guard lock(memberLock);
+    ui failed=0;
+
+    if (group.empty()) {
+        for (const auto handleData : members)
+            if (!Send(handleData, payload->data(), payload->size(), &payload)) ++failed;
+        return failed;
+    }
+
+    auto it=groups.find(group);
+    if (it==groups.end()) return 0;
+    for (const auto handleData : it->second)
+        if (!Send(handleData, payload->data(), payload->size(), &payload)) ++failed;
+    return failed;
+}
@@ -0,0 +1,248 @@
+#ifdef __linux__
+
+#include "MyEventLoop.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace {
+    constexpr int MAX_EVENTS=64;
+    constexpr int MAX_ACCEPTS=64; // 每次唤醒最多连续accept的连接数
+    constexpr unsigned MAX_IOV=64; // 每次writev最多合并的数据块
+
+    bool SetNonBlocking(const SOCKET sock) {
+        const int flags=fcntl(sock, F_GETFL, 0);
+        return flags!=-1&&fcntl(sock, F_SETFL, flags|O_NONBLOCK)!=-1;
+    }
+}
+
+// 每个循环只由一个Work线程等待，连接在生命周期内固定属于一个循环
+// 使用边缘触发，EPOLLIN/EPOLLOUT只在注册时设置一次
+// Work线程处理事件时产生的发送先排队，下一次Wait开始时用writev合并写出
+class MyEpollLoop final : public MyEventLoop {
+    public:
+        ~MyEpollLoop() override {
+            if (epollFd!=-1) close(epollFd);
+            if (wakeFd!=-1) close(wakeFd);
+        }
+
+        bool Open() override {
+            epollFd=epoll_create1(EPOLL_CLOEXEC);
+            wakeFd=eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+            if (epollFd==-1||wakeFd==-1) return false;
+
+            epoll_event ev{};
+            ev.events=EPOLLIN; // 唤醒事件，用于Stop和投递任务
+            ev.data.ptr=nullptr;
+            return epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev)==0;
+        }
+
+        bool Shared()const override {return false;}
+
+        bool Listen(const SOCKET listenSocket) override {
+            if (!SetNonBlocking(listenSocket)) return false;
+            this->listenSocket=listenSocket;
+
+            // 多个循环共享同一个监听套接字时只唤醒其中一个
+            epoll_event ev{};
+            ev.events=EPOLLIN|EPOLLEXCLUSIVE;
+            ev.data.ptr=&this->listenSocket;
+            return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenSocket, &ev)==0;
+        }
+
+        bool Attach(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            if (!SetNonBlocking(handleData->socket)) return false;
+
+            epoll_event ev{};
+            ev.events=EPOLLIN|EPOLLOUT|EPOLLRDHUP|EPOLLET;
+            ev.data.ptr=handleData;
+            return epoll_ctl(epollFd, EPOLL_CTL_ADD, handleData->socket, &ev)==0;
+        }
+
+        bool Wait(Event& event) override {
+            Own();
+            RunTasks();
+            FlushCorked();
+
+            while (true) {
+                if (stopped.load(std::memory_order_acquire)) return false;
+                if (NextAccepted(event)) return true;
+
+                while (cursor<count) {
+                    epoll_event& ev=events[cursor];
+                    if (ev.data.ptr==nullptr) {
+                        // 被Stop或Post唤醒
+                        ++cursor;
+                        uint64_t value;
+                        [[maybe_unused]] const ssize_t ret=read(wakeFd, &value, sizeof(value));
+                        RunTasks();
+                        FlushCorked();
+                        if (stopped.load(std::memory_order_acquire)) return false;
+                        continue;
+                    }
+
+                    if (ev.data.ptr==&listenSocket) {
+                        ++cursor;
+                        DrainAccept();
+                        if (NextAccepted(event)) return true;
+                        continue;
+                    }
+
+                    const auto handleData=static_cast<MySocketX::LPPER_HANDLE_DATA>(ev.data.ptr);
+                    if (ev.events&EPOLLOUT) {
+                        Write(handleData);
+                        ev.events&=~EPOLLOUT;
+                    }
+
+                    if (!(ev.events&(EPOLLIN|EPOLLRDHUP|EPOLLHUP|EPOLLERR))) {
+                        ++cursor;
+                        continue;
+                    }
+
+                    // 边缘触发需要读到EAGAIN；读满缓冲区时保留该事件，下次Wait继续读
+                    const ssize_t n=recv(handleData->socket, handleData->recvData->buffer, DATA_SIZE, 0);
+                    if (n>0) {
+                        if (n<DATA_SIZE) ++cursor; // 短读说明内核缓冲区已读空
+                        event={handleData, handleData->recvData->buffer, static_cast<DWORD>(n), true, INVALID_SOCKET};
+                        return true;
+                    }
+                    if (n<0&&errno==EINTR) continue;
+
+                    ++cursor;
+                    if (n==0) {
+                        event={handleData, nullptr, 0, true, INVALID_SOCKET};
+                        return true;
+                    }
+                    if (errno==EAGAIN||errno==EWOULDBLOCK) continue;
+
+                    event={handleData, nullptr, 0, false, INVALID_SOCKET};
+                    return true;
+                }
+
+                cursor=0;
+                count=epoll_wait(epollFd, events, MAX_EVENTS, -1);
+                if (count<0) {
+                    count=0;
+                    if (errno!=EINTR) return false;
+                }
+            }
+        }
+
+        bool Receive(MySocketX::LPPER_HANDLE_DATA) override {
+            return true; // 连接一直处于监听状态，无需重新投递
+        }
+
+        bool Send(const MySocketX::LPPER_HANDLE_DATA handleData, const char* data, const size_t len,
+            const SharedPayload* shared) override {
+            // 只由所属Work线程调用，其他线程的发送已通过Post转到该线程，无需加锁
+            SendQueue& queue=handleData->sendQueue;
+
+            // 对端读取过慢时拒绝继续排队
+            if (!queue.Empty()&&queue.Bytes()+len>SEND_QUEUE_LIMIT) return false;
+
+            // 队列为空时登记连接，与本轮产生的其他消息一起在下一次Wait开始时合并写出
+            // 队列不为空时连接已登记或正在等待EPOLLOUT
+            if (queue.Empty()) corked.push_back(handleData);
+            queue.Push(data, len, shared);
+            return true;
+        }
+
+        bool Detach(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            if (InLoop()) corked.erase(std::remove(corked.begin(), corked.end(), handleData), corked.end());
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, handleData->socket, nullptr);
+            return true;
+        }
+
+        void Stop(ui) override {
+            stopped.store(true, std::memory_order_release);
+            Signal();
+        }
+
+    protected:
+        void Wake() override {
+            if (!InLoop()) Signal(); // Work线程自己投递的任务在下一次Wait开始时执行
+        }
+
+    private:
+        void Signal() {
+            constexpr uint64_t one=1;
+            [[maybe_unused]] const ssize_t ret=write(wakeFd, &one, sizeof(one));
+        }
+
+        // 写出事件处理期间排队的数据
+        void FlushCorked() {
+            for (const auto handleData : corked)
+                Write(handleData);
+            corked.clear();
+        }
+
+        // 监听套接字为水平触发，一次取不完的连接在下次epoll_wait时继续
+        void DrainAccept() {
+            acceptCount=acceptCursor=0;
+            while (acceptCount<MAX_ACCEPTS) {
+                const SOCKET sock=accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK|SOCK_CLOEXEC);
+                if (sock!=INVALID_SOCKET) {
+                    accepted[acceptCount++]=sock;
+                    continue;
+                }
+                if (errno==EINTR||errno==ECONNABORTED) continue;
+                break; // EAGAIN或文件描述符耗尽
+            }
+        }
+
+        bool NextAccepted(Event& event) {
+            if (acceptCursor>=acceptCount) return false;
+            event={nullptr, nullptr, 0, true, accepted[acceptCursor++]};
+            return true;
+        }
+
+        // 将队列中的数据块合并为一次writev，直到写完或内核缓冲区已满
+        static void Write(const MySocketX::LPPER_HANDLE_DATA handleData) {
+            SendQueue& queue=handleData->sendQueue;
+
+            iovec iov[MAX_IOV];
+            while (!queue.Empty()) {
+                const unsigned count=queue.Gather(MAX_IOV, [&](const unsigned i, const char* data, const size_t len) {
+                    iov[i]={const_cast<char*>(data), len};
+                });
+
+                msghdr msg{};
+                msg.msg_iov=iov;
+                msg.msg_iovlen=count;
+                const ssize_t n=sendmsg(handleData->socket, &msg, MSG_NOSIGNAL);
+                if (n>0) {
+                    queue.Consume(n);
+                    continue;
+                }
+                if (n<0&&errno==EINTR) continue;
+                break; // EAGAIN等待下一次EPOLLOUT，其他错误由接收端处理关闭
+            }
+        }
+
+    private:
+        int epollFd=-1;
+        int wakeFd=-1;
+        epoll_event events[MAX_EVENTS]{};
+        int count=0;
+        int cursor=0;
+
+        SOCKET listenSocket=INVALID_SOCKET;
+        SOCKET accepted[MAX_ACCEPTS]{};
+        int acceptCount=0;
+        int acceptCursor=0;
+
+        std::vector<MySocketX::LPPER_HANDLE_DATA> corked; // 等待合并写出的连接，只由Work线程访问
+        std::atomic<bool> stopped{false};
+};
+
+std::unique_ptr<MyEventLoop> CreateEpollLoop() {
+    return std::make_unique<MyEpollLoop>();
+}
+
+#endif
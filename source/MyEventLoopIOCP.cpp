@@ -0,0 +1,187 @@
+#ifdef _WIN32
+
+#include "MyEventLoop.h"
+
+namespace {
+    constexpr unsigned MAX_BUFFERS=64; // 每次WSASend最多合并的数据块
+    constexpr size_t SEND_BATCH=256*1024; // 每次WSASend最多转移的字节数
+    constexpr ULONG_PTR WAKE_KEY=1; // Post唤醒使用的完成键，Stop使用0
+}
+
+// 每个连接同时只有一个WSASend，其余数据在sendQueue中排队，完成后整批转移到发送上下文中一次发出
+// 发送状态由各连接的sendLock保护，共享完成端口时不同连接的发送互不竞争
+// 默认所有Work线程共享一个完成端口；独占模式下每个线程一个完成端口，连接固定由一个线程处理
+class MyIOCPLoop final : public MyEventLoop {
+    public:
+        explicit MyIOCPLoop(const bool shared):shared(shared) {}
+
+        ~MyIOCPLoop() override {
+            if (iocp!=nullptr) CloseHandle(iocp);
+        }
+
+        bool Open() override {
+            iocp=CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+            return iocp!=nullptr;
+        }
+
+        bool Shared()const override {return shared;}
+
+        bool Attach(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            if (CreateIoCompletionPort(reinterpret_cast<HANDLE>(handleData->socket), iocp,
+                reinterpret_cast<ULONG_PTR>(handleData), 0)==nullptr)
+                return false;
+
+            return Receive(handleData);
+        }
+
+        bool Wait(Event& event) override {
+            DWORD transferredBytes;
+            ULONG_PTR completionKey;
+            LPOVERLAPPED overlapped;
+
+            if (!shared) {
+                Own();
+                RunTasks();
+            }
+
+            while (true) {
+                overlapped=nullptr;
+                const BOOL ok=GetQueuedCompletionStatus(iocp, &transferredBytes,
+                    &completionKey, &overlapped, INFINITE);
+
+                if (overlapped==nullptr) {
+                    if (ok==TRUE&&completionKey==WAKE_KEY) {
+                        RunTasks();
+                        continue;
+                    }
+                    return false; // Stop投递的空包或完成端口已关闭
+                }
+
+                const auto lpIoData=reinterpret_cast<MySocketX::LPPER_IO_DATA>(overlapped);
+                if (lpIoData->state!=ProcessState::RECEIVE) {
+                    HandleSend(lpIoData, reinterpret_cast<MySocketX::LPPER_HANDLE_DATA>(completionKey),
+                        ok==TRUE, transferredBytes);
+                    continue;
+                }
+
+                const auto handleData=reinterpret_cast<MySocketX::LPPER_HANDLE_DATA>(completionKey);
+                event={handleData, lpIoData->buffer, transferredBytes, ok==TRUE, INVALID_SOCKET};
+                return true;
+            }
+        }
+
+        bool Receive(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            const auto lpIoData=handleData->recvData;
+            ZeroMemory(&(lpIoData->overlapped), sizeof(WSAOVERLAPPED));
+            lpIoData->wsabuf.buf=lpIoData->buffer;
+            lpIoData->wsabuf.len=DATA_SIZE;
+            lpIoData->socket=handleData->socket;
+            lpIoData->state=ProcessState::RECEIVE;
+
+            DWORD flags=0;
+            if (WSARecv(handleData->socket, &(lpIoData->wsabuf), 1, &(lpIoData->bytesReceived), &flags,
+                &(lpIoData->overlapped), nullptr)==SOCKET_ERROR)
+                return WSAGetLastError()==WSA_IO_PENDING;
+
+            return true;
+        }
+
+        bool Send(const MySocketX::LPPER_HANDLE_DATA handleData, const char* data, const size_t len,
+            const SharedPayload* shared) override {
+            std::lock_guard lock(handleData->sendLock);
+            SendQueue& queue=handleData->sendQueue;
+
+            // 对端读取过慢时拒绝继续排队
+            if (!queue.Empty()&&queue.Bytes()+len>SEND_QUEUE_LIMIT) return false;
+
+            queue.Push(data, len, shared);
+            if (handleData->pendingSend!=nullptr) return true; // 上一次发送完成后继续写出
+
+            return StartSend(handleData);
+        }
+
+        bool Detach(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            // closesocket会取消未完成的请求，完成事件仍会到达，handleData留到那时与发送上下文一起释放
+            std::lock_guard lock(handleData->sendLock);
+            if (handleData->pendingSend==nullptr) return true;
+
+            static_cast<MySocketX::LPPER_IO_DATA>(handleData->pendingSend)->state=ProcessState::CLOSE;
+            return false;
+        }
+
+        void Stop(const ui workers) override {
+            for (ui i=0;i<workers;++i)
+                PostQueuedCompletionStatus(iocp, 0, 0, nullptr);
+        }
+
+    protected:
+        void Wake() override {
+            if (!InLoop()) PostQueuedCompletionStatus(iocp, 0, WAKE_KEY, nullptr);
+        }
+
+    private:
+        // 以下函数调用方需持有连接的sendLock
+        bool StartSend(const MySocketX::LPPER_HANDLE_DATA handleData) {
+            const auto lpIoData=ioPool.Acquire();
+            lpIoData->socket=handleData->socket;
+            lpIoData->state=ProcessState::SEND;
+            handleData->sendQueue.MoveTo(lpIoData->sendData, MAX_BUFFERS, SEND_BATCH);
+
+            handleData->pendingSend=lpIoData;
+            if (PostSend(lpIoData)) return true;
+
+            handleData->pendingSend=nullptr;
+            ioPool.Release(lpIoData);
+            return false;
+        }
+
+        static bool PostSend(const MySocketX::LPPER_IO_DATA lpIoData) {
+            // WSASend返回前会复制WSABUF数组，数组本身可以放在栈上
+            WSABUF buffers[MAX_BUFFERS];
+            const unsigned count=lpIoData->sendData.Gather(MAX_BUFFERS, [&](const unsigned i, const char* data, const size_t len) {
+                buffers[i].buf=const_cast<char*>(data);
+                buffers[i].len=static_cast<ULONG>(len);
+            });
+
+            ZeroMemory(&(lpIoData->overlapped), sizeof(WSAOVERLAPPED));
+            if (WSASend(lpIoData->socket, buffers, count, nullptr, 0, &(lpIoData->overlapped), nullptr)==SOCKET_ERROR)
+                return WSAGetLastError()==WSA_IO_PENDING;
+
+            return true;
+        }
+
+        void HandleSend(const MySocketX::LPPER_IO_DATA lpIoData, const MySocketX::LPPER_HANDLE_DATA handleData,
+            const bool ok, const DWORD bytes) {
+            std::unique_lock lock(handleData->sendLock);
+
+            // 连接已关闭，Detach把handleData留到这里释放
+            if (lpIoData->state==ProcessState::CLOSE) {
+                handleData->pendingSend=nullptr;
+                lock.unlock();
+                ioPool.Release(lpIoData);
+                handlePool.Release(handleData);
+                return;
+            }
+
+            if (ok&&bytes>0) {
+                lpIoData->sendData.Consume(bytes);
+                if (!lpIoData->sendData.Empty()&&PostSend(lpIoData)) return; // 部分写出，继续发送剩余数据
+            }
+
+            // 发送完成或失败，失败时由接收端处理关闭
+            handleData->pendingSend=nullptr;
+            const bool done=ok&&bytes>0&&lpIoData->sendData.Empty();
+            ioPool.Release(lpIoData);
+            if (done&&!handleData->sendQueue.Empty()) StartSend(handleData);
+        }
+
+    private:
+        HANDLE iocp{};
+        bool shared;
+};
+
+std::unique_ptr<MyEventLoop> CreateIOCPLoop(const bool shared) {
+    return std::make_unique<MyIOCPLoop>(shared);
+}
+
+#endif
@@ -0,0 +1,634 @@
+#ifdef __linux__
+
+#include "MyEventLoop.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace {
+    constexpr unsigned RING_ENTRIES=256;
+    constexpr unsigned RECV_BUFFERS=1024; // 提供给内核的接收缓冲区数量，必须为2的幂
+    constexpr unsigned SEND_SLOTS=256; // 注册的固定发送缓冲区数量
+    constexpr unsigned MAX_IOV=64; // 每次sendmsg最多合并的数据块
+    constexpr size_t SEND_BATCH=256*1024; // 每次sendmsg最多转移的字节数
+    constexpr unsigned short BUFFER_GROUP=0;
+
+    // user_data低3位用于区分请求类型，指针至少8字节对齐
+    constexpr uint64_t TAG_RECV=0;
+    constexpr uint64_t TAG_SEND=1;
+    constexpr uint64_t TAG_ACCEPT=2;
+    constexpr uint64_t TAG_STOP=3;
+    constexpr uint64_t TAG_PROBE=4;
+    constexpr uint64_t TAG_CANCEL=5;
+    constexpr uint64_t TAG_WAKE=6;
+    constexpr uint64_t TAG_MASK=7;
+
+    int Setup(const unsigned entries, io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int Enter(const int fd, const unsigned toSubmit, const unsigned minComplete, const unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    int Register(const int fd, const unsigned opcode, void* arg, const unsigned count) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+}
+
+// 基于io_uring的完成模型：多发accept、多发recv配合提供缓冲区环，发送使用注册的固定缓冲区
+// 每个循环只由一个Work线程等待，其他线程提交请求时持有sqLock并立即提交
+// 提交队列没有空位时Work线程的请求推迟到下一次等待前重新投递，其他线程放弃或稍后重试
+// 积压不超过一个固定缓冲区的数据拷贝后WRITE_FIXED，更多的数据块转移到请求中用sendmsg一次写出
+class MyUringLoop final : public MyEventLoop {
+    struct SendRequest {
+        MySocketX::LPPER_HANDLE_DATA handleData; // 连接关闭后置空
+        char* buffer; // 固定缓冲区
+        int slot; // 固定缓冲区下标，-1表示使用data
+        size_t offset;
+        size_t length;
+        SendQueue data; // 请求持有的数据块，连接关闭后仍然有效
+        msghdr msg;
+        iovec iov[MAX_IOV];
+    };
+
+    public:
+        ~MyUringLoop() override {
+            if (ringFd!=-1) close(ringFd);
+            if (ringPtr!=MAP_FAILED) munmap(ringPtr, ringSize);
+            if (sqes!=MAP_FAILED) munmap(sqes, sqesSize);
+            if (bufRing!=MAP_FAILED) munmap(bufRing, RECV_BUFFERS*sizeof(io_uring_buf));
+            if (recvBuffers!=MAP_FAILED) munmap(recvBuffers, RECV_BUFFERS*DATA_SIZE);
+            if (sendBuffers!=MAP_FAILED) munmap(sendBuffers, SEND_SLOTS*DATA_SIZE);
+        }
+
+        bool Open() override {
+            io_uring_params params{};
+            params.flags=IORING_SETUP_CQSIZE;
+            params.cq_entries=RING_ENTRIES*16; // 多发请求会产生大量完成事件
+            ringFd=Setup(RING_ENTRIES, &params);
+            if (ringFd<0) return false;
+            if (!(params.features&IORING_FEAT_SINGLE_MMAP)||!(params.features&IORING_FEAT_NODROP)) return false;
+
+            // 映射提交队列和完成队列
+            ringSize=std::max(params.sq_off.array+params.sq_entries*sizeof(unsigned),
+                params.cq_off.cqes+params.cq_entries*sizeof(io_uring_cqe));
+            ringPtr=mmap(nullptr, ringSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+            sqesSize=params.sq_entries*sizeof(io_uring_sqe);
+            sqes=mmap(nullptr, sqesSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFd, IORING_OFF_SQES);
+            if (ringPtr==MAP_FAILED||sqes==MAP_FAILED) return false;
+
+            const auto base=static_cast<char*>(ringPtr);
+            sqHead=reinterpret_cast<unsigned*>(base+params.sq_off.head);
+            sqTail=reinterpret_cast<unsigned*>(base+params.sq_off.tail);
+            sqArray=reinterpret_cast<unsigned*>(base+params.sq_off.array);
+            sqMask=*reinterpret_cast<unsigned*>(base+params.sq_off.ring_mask);
+            sqEntries=params.sq_entries;
+            sqLocalTail=*sqTail;
+            cqHead=reinterpret_cast<unsigned*>(base+params.cq_off.head);
+            cqTail=reinterpret_cast<unsigned*>(base+params.cq_off.tail);
+            cqMask=*reinterpret_cast<unsigned*>(base+params.cq_off.ring_mask);
+            cqes=reinterpret_cast<io_uring_cqe*>(base+params.cq_off.cqes);
+
+            // 接收缓冲区环，内核在数据到达时才选取缓冲区，连接本身不占用接收内存
+            bufRing=mmap(nullptr, RECV_BUFFERS*sizeof(io_uring_buf), PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            recvBuffers=mmap(nullptr, RECV_BUFFERS*DATA_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if (bufRing==MAP_FAILED||recvBuffers==MAP_FAILED) return false;
+
+            io_uring_buf_reg reg{};
+            reg.ring_addr=reinterpret_cast<uint64_t>(bufRing);
+            reg.ring_entries=RECV_BUFFERS;
+            reg.bgid=BUFFER_GROUP;
+            if (Register(ringFd, IORING_REGISTER_PBUF_RING, &reg, 1)<0) return false;
+
+            for (unsigned i=0;i<RECV_BUFFERS;++i)
+                PushBuffer(i);
+            CommitBuffers();
+
+            // 固定发送缓冲区，内核省去每次发送时的页面映射
+            sendBuffers=mmap(nullptr, SEND_SLOTS*DATA_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if (sendBuffers==MAP_FAILED) return false;
+
+            std::vector<iovec> iovecs(SEND_SLOTS);
+            slotRequests.resize(SEND_SLOTS);
+            for (unsigned i=0;i<SEND_SLOTS;++i) {
+                iovecs[i]={static_cast<char*>(sendBuffers)+i*DATA_SIZE, DATA_SIZE};
+                freeSlots.push_back(static_cast<int>(SEND_SLOTS-1-i));
+            }
+            if (Register(ringFd, IORING_REGISTER_BUFFERS, iovecs.data(), SEND_SLOTS)<0) return false;
+
+            return ProbeMultishot();
+        }
+
+        bool Shared()const override {return false;}
+
+        bool Listen(const SOCKET listenSocket) override {
+            std::lock_guard lock(sqLock);
+            this->listenSocket=listenSocket;
+            return PrepareAccept()&&Submit(true);
+        }
+
+        bool Attach(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            std::lock_guard lock(sqLock);
+            handleData->pendingSend=nullptr;
+            return PrepareRecv(handleData)&&Submit(!InLoop());
+        }
+
+        bool Wait(Event& event) override {
+            Own();
+            RunTasks();
+            Resubmit();
+
+            while (!stopped) {
+                io_uring_cqe cqe;
+                if (!reaped.empty()) {
+                    cqe=reaped.front();
+                    reaped.pop_front();
+                }
+                else {
+                    const unsigned head=*cqHead;
+                    if (head==__atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                        // Wake没有空位投递时任务也在这里执行
+                        RunTasks();
+                        Resubmit();
+
+                        // 提交本线程积压的请求并等待至少一个完成事件
+                        unsigned pending;
+                        {
+                            std::lock_guard lock(sqLock);
+                            __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+                            pending=sqLocalTail-__atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+                        }
+                        if (Enter(ringFd, pending, 1, IORING_ENTER_GETEVENTS)<0&&errno!=EINTR&&errno!=EBUSY&&errno!=EAGAIN) {
+                            MYLOG_ERROR("io_uring_enter failed: {}", strerror(errno));
+                            return false;
+                        }
+                        continue;
+                    }
+
+                    cqe=cqes[head&cqMask];
+                    __atomic_store_n(cqHead, head+1, __ATOMIC_RELEASE);
+                }
+
+                switch (cqe.user_data&TAG_MASK) {
+                    case TAG_RECV:
+                        if (HandleRecv(cqe, event)) return true;
+                        break;
+
+                    case TAG_SEND:
+                        HandleSend(cqe);
+                        break;
+
+                    case TAG_ACCEPT:
+                        if (cqe.res==-ECANCELED||cqe.res==-EINVAL||cqe.res==-EBADF) break; // 监听套接字已关闭
+                        if (!(cqe.flags&IORING_CQE_F_MORE)) {
+                            std::lock_guard lock(sqLock);
+                            if (!PrepareAccept()) acceptPending=true;
+                        }
+                        if (cqe.res<0) break;
+                        event={nullptr, nullptr, 0, true, cqe.res};
+                        return true;
+
+                    case TAG_STOP:
+                        stopped=true;
+                        break;
+
+                    case TAG_WAKE:
+                        RunTasks();
+                        Resubmit();
+                        break;
+
+                    default: break;
+                }
+            }
+
+            return false;
+        }
+
+        bool Receive(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            // 归还本次事件使用的缓冲区
+            if (currentBuffer>=0) {
+                PushBuffer(currentBuffer);
+                CommitBuffers();
+                currentBuffer=-1;
+            }
+
+            // 多发recv已结束时重新投递
+            if (rearm==handleData) {
+                rearm=nullptr;
+                std::lock_guard lock(sqLock);
+                if (!PrepareRecv(handleData)) rearmPending.push_back(handleData);
+            }
+
+            return true;
+        }
+
+        bool Send(const MySocketX::LPPER_HANDLE_DATA handleData, const char* data, const size_t len,
+            const SharedPayload* shared) override {
+            std::lock_guard lock(sqLock);
+            SendQueue& queue=handleData->sendQueue;
+
+            // 对端读取过慢时拒绝继续排队
+            if (!queue.Empty()&&queue.Bytes()+len>SEND_QUEUE_LIMIT) return false;
+
+            // 同一连接同时只有一个发送请求，其余数据排队，完成后合并发送
+            const bool idle=handleData->pendingSend==nullptr&&queue.Empty();
+            queue.Push(data, len, shared);
+            if (!idle) return true;
+
+            // Work线程自身的发送等本次事件处理完后统一发起，其他线程没有空位时也交给Work线程
+            if (InLoop()||!StartSend(handleData)) {
+                corked.push_back(handleData);
+                return true;
+            }
+            return Submit(true);
+        }
+
+        bool Detach(const MySocketX::LPPER_HANDLE_DATA handleData) override {
+            std::lock_guard lock(sqLock);
+            corked.erase(std::remove(corked.begin(), corked.end(), handleData), corked.end());
+            rearmPending.erase(std::remove(rearmPending.begin(), rearmPending.end(), handleData), rearmPending.end());
+            if (handleData->pendingSend==nullptr) return true;
+
+            // 取消进行中的发送，完成事件到达时只释放请求；没有空位时不取消，发送结束后同样只释放请求
+            const auto request=static_cast<SendRequest*>(handleData->pendingSend);
+            request->handleData=nullptr;
+            handleData->pendingSend=nullptr;
+            if (PrepareCancel(reinterpret_cast<uint64_t>(request)|TAG_SEND)) Submit(!InLoop());
+            return true;
+        }
+
+        void Stop(ui) override {
+            // 停止请求不能丢失，没有空位时释放锁等Work线程处理完成事件后重试
+            bool acceptCancelled=false;
+            while (true) {
+                {
+                    std::lock_guard lock(sqLock);
+                    if (!acceptCancelled) acceptCancelled=listenSocket==INVALID_SOCKET||PrepareCancel(TAG_ACCEPT);
+                    if (acceptCancelled&&PrepareNop(TAG_STOP)) {
+                        Submit(true);
+                        return;
+                    }
+                    Submit(true);
+                }
+                std::this_thread::yield();
+            }
+        }
+
+    protected:
+        void Wake() override {
+            if (InLoop()) return; // Work线程自己投递的任务在下一次Wait开始时执行
+
+            // 没有空位时放弃唤醒，Work线程每次空闲等待前都会执行积压的任务
+            std::lock_guard lock(sqLock);
+            if (PrepareNop(TAG_WAKE)) Submit(true);
+        }
+
+    private:
+        // 重新投递因提交队列已满推迟的请求，并为事件处理期间排队的连接发起发送，随下一次enter一起提交
+        void Resubmit() {
+            std::lock_guard lock(sqLock);
+            if (acceptPending) acceptPending=!PrepareAccept();
+            while (!rearmPending.empty()&&PrepareRecv(rearmPending.back()))
+                rearmPending.pop_back();
+            while (!stalledSends.empty()) {
+                SendRequest* request=stalledSends.back();
+                if (request->handleData==nullptr) ReleaseRequest(request); // 等待期间连接已关闭
+                else if (!PrepareSend(request)) return;
+                stalledSends.pop_back();
+            }
+
+            size_t started=0;
+            for (;started<corked.size();++started) {
+                const auto handleData=corked[started];
+                if (handleData->pendingSend==nullptr&&!handleData->sendQueue.Empty()&&!StartSend(handleData)) break;
+            }
+            corked.erase(corked.begin(), corked.begin()+static_cast<std::ptrdiff_t>(started));
+        }
+
+        // 以下函数调用方需持有sqLock
+        // 提交队列已满时先提交，内核因CQ溢出拒绝时Work线程取出完成事件后重试，仍没有空位返回nullptr
+        io_uring_sqe* GetSqe() {
+            while (sqLocalTail-__atomic_load_n(sqHead, __ATOMIC_ACQUIRE)>=sqEntries) {
+                __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+                const int submitted=Enter(ringFd, sqLocalTail-__atomic_load_n(sqHead, __ATOMIC_ACQUIRE), 0, 0);
+                if (submitted>0) continue;
+                if (submitted<0&&errno==EINTR) continue;
+                if (submitted<0&&errno==EBUSY&&InLoop()&&Reap()) continue;
+                return nullptr;
+            }
+
+            const unsigned index=sqLocalTail&sqMask;
+            io_uring_sqe* sqe=static_cast<io_uring_sqe*>(sqes)+index;
+            memset(sqe, 0, sizeof(io_uring_sqe));
+            sqArray[index]=index;
+            ++sqLocalTail;
+            return sqe;
+        }
+
+        // Work线程自身的请求留到下一次Wait统一提交，其他线程需要立即提交
+        bool Submit(const bool now) {
+            __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+            if (!now) return true;
+
+            const unsigned pending=sqLocalTail-__atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            return pending==0||Enter(ringFd, pending, 0, 0)>=0;
+        }
+
+        // 把CQ中的完成事件移到reaped，留给Wait处理，只能由Work线程调用
+        bool Reap() {
+            const unsigned tail=__atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            unsigned head=*cqHead;
+            if (head==tail) return false;
+            for (;head!=tail;++head)
+                reaped.push_back(cqes[head&cqMask]);
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        bool PrepareNop(const uint64_t tag) {
+            io_uring_sqe* sqe=GetSqe();
+            if (sqe==nullptr) return false;
+            sqe->opcode=IORING_OP_NOP;
+            sqe->user_data=tag;
+            return true;
+        }
+
+        bool PrepareCancel(const uint64_t target) {
+            io_uring_sqe* sqe=GetSqe();
+            if (sqe==nullptr) return false;
+            sqe->opcode=IORING_OP_ASYNC_CANCEL;
+            sqe->addr=target;
+            sqe->user_data=TAG_CANCEL;
+            return true;
+        }
+
+        bool PrepareAccept() {
+            io_uring_sqe* sqe=GetSqe();
+            if (sqe==nullptr) return false;
+            sqe->opcode=IORING_OP_ACCEPT;
+            sqe->fd=listenSocket;
+            sqe->ioprio=IORING_ACCEPT_MULTISHOT;
+            sqe->accept_flags=SOCK_CLOEXEC;
+            sqe->user_data=TAG_ACCEPT;
+            return true;
+        }
+
+        bool PrepareRecv(const MySocketX::LPPER_HANDLE_DATA handleData) {
+            io_uring_sqe* sqe=GetSqe();
+            if (sqe==nullptr) return false;
+            sqe->opcode=IORING_OP_RECV;
+            sqe->fd=handleData->socket;
+            sqe->ioprio=IORING_RECV_MULTISHOT;
+            sqe->flags=IOSQE_BUFFER_SELECT;
+            sqe->buf_group=BUFFER_GROUP;
+            sqe->user_data=reinterpret_cast<uint64_t>(handleData)|TAG_RECV;
+            return true;
+        }
+
+        bool PrepareSend(SendRequest* request) {
+            io_uring_sqe* sqe=GetSqe();
+            if (sqe==nullptr) return false;
+            PrepareSend(sqe, request);
+            return true;
+        }
+
+        void PrepareSend(io_uring_sqe* sqe, SendRequest* request) {
+            if (request->slot>=0) {
+                sqe->opcode=IORING_OP_WRITE_FIXED;
+                sqe->buf_index=request->slot;
+                sqe->addr=reinterpret_cast<uint64_t>(request->buffer+request->offset);
+                sqe->len=static_cast<unsigned>(request->length-request->offset);
+            }
+            else {
+                const unsigned count=request->data.Gather(MAX_IOV, [&](const unsigned i, const char* data, const size_t len) {
+                    request->iov[i]={const_cast<char*>(data), len};
+                });
+                request->msg={};
+                request->msg.msg_iov=request->iov;
+                request->msg.msg_iovlen=count;
+
+                sqe->opcode=IORING_OP_SENDMSG;
+                sqe->msg_flags=MSG_NOSIGNAL;
+                sqe->addr=reinterpret_cast<uint64_t>(&request->msg);
+                sqe->len=1;
+            }
+            sqe->fd=request->handleData->socket;
+            sqe->user_data=reinterpret_cast<uint64_t>(request)|TAG_SEND;
+            request->handleData->pendingSend=request;
+        }
+
+        SendRequest* AcquireSlot(const MySocketX::LPPER_HANDLE_DATA handleData) {
+            const int slot=freeSlots.back();
+            freeSlots.pop_back();
+
+            SendRequest* request=&slotRequests[slot];
+            request->handleData=handleData;
+            request->buffer=static_cast<char*>(sendBuffers)+slot*DATA_SIZE;
+            request->slot=slot;
+            request->offset=request->length=0;
+            return request;
+        }
+
+        void ReleaseRequest(SendRequest* request) {
+            if (request->slot>=0) freeSlots.push_back(request->slot);
+            else requestPool.Release(request);
+        }
+
+        // 从sendQueue取出下一批数据发送，没有空位时数据留在队列中并返回false
+        bool StartSend(const MySocketX::LPPER_HANDLE_DATA handleData) {
+            io_uring_sqe* sqe=GetSqe();
+            if (sqe==nullptr) return false;
+
+            SendQueue& queue=handleData->sendQueue;
+            SendRequest* request;
+
+            // 只有自有数据的少量积压拷贝到注册缓冲区，引用共享负载时整体转移，广播不按连接拷贝
+            if (!queue.HasShared()&&queue.Bytes()<=DATA_SIZE&&!freeSlots.empty()) {
+                request=AcquireSlot(handleData);
+                request->length=queue.CopyTo(request->buffer, DATA_SIZE);
+            }
+            else {
+                // 数据块整体转移到请求中，不做拷贝
+                request=requestPool.Acquire();
+                request->handleData=handleData;
+                request->slot=-1;
+                queue.MoveTo(request->data, MAX_IOV, SEND_BATCH);
+            }
+
+            PrepareSend(sqe, request);
+            return true;
+        }
+
+        bool HandleRecv(const io_uring_cqe& cqe, Event& event) {
+            const auto handleData=reinterpret_cast<MySocketX::LPPER_HANDLE_DATA>(cqe.user_data&~TAG_MASK);
+
+            if (cqe.res==-ENOBUFS) {
+                // 缓冲区暂时用尽，处理中的缓冲区归还后即可继续接收
+                std::lock_guard lock(sqLock);
+                if (!PrepareRecv(handleData)) rearmPending.push_back(handleData);
+                return false;
+            }
+
+            if (cqe.res>0) {
+                if (!(cqe.flags&IORING_CQE_F_MORE)) rearm=handleData;
+                currentBuffer=static_cast<int>(cqe.flags>>IORING_CQE_BUFFER_SHIFT);
+                event={handleData, static_cast<char*>(recvBuffers)+currentBuffer*DATA_SIZE,
+                    static_cast<DWORD>(cqe.res), true, INVALID_SOCKET};
+                return true;
+            }
+
+            if (cqe.res<0) errno=-cqe.res;
+            event={handleData, nullptr, 0, cqe.res==0, INVALID_SOCKET};
+            return true;
+        }
+
+        void HandleSend(const io_uring_cqe& cqe) {
+            std::lock_guard lock(sqLock);
+            const auto request=reinterpret_cast<SendRequest*>(cqe.user_data&~TAG_MASK);
+            const auto handleData=request->handleData;
+
+            if (handleData==nullptr||cqe.res<=0) {
+                // 连接已关闭或发送失败，由接收端处理关闭
+                if (handleData!=nullptr) handleData->pendingSend=nullptr;
+                ReleaseRequest(request);
+                return;
+            }
+
+            bool remaining;
+            if (request->slot>=0) {
+                request->offset+=cqe.res;
+                remaining=request->offset<request->length;
+            }
+            else {
+                request->data.Consume(cqe.res);
+                remaining=!request->data.Empty();
+            }
+
+            if (remaining) {
+                if (!PrepareSend(request)) stalledSends.push_back(request); // 部分写出，继续发送剩余数据
+                return;
+            }
+
+            handleData->pendingSend=nullptr;
+            ReleaseRequest(request);
+            if (!handleData->sendQueue.Empty()&&!StartSend(handleData))
+                corked.push_back(handleData);
+        }
+
+        // io_uring_buf_ring::bufs在C++下偏移不为0，直接按io_uring_buf数组访问，tail与bufs[0].resv重叠
+        void PushBuffer(const unsigned id) {
+            io_uring_buf& buf=static_cast<io_uring_buf*>(bufRing)[bufTail&(RECV_BUFFERS-1)];
+            buf.addr=reinterpret_cast<uint64_t>(static_cast<char*>(recvBuffers)+id*DATA_SIZE);
+            buf.len=DATA_SIZE;
+            buf.bid=static_cast<unsigned short>(id);
+            ++bufTail;
+        }
+
+        void CommitBuffers() {
+            __atomic_store_n(&static_cast<io_uring_buf*>(bufRing)->resv, bufTail, __ATOMIC_RELEASE);
+        }
+
+        // 多发recv需要6.0以上内核，用socketpair实际投递一次确认
+        bool ProbeMultishot() {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0, fds)<0) return false;
+            [[maybe_unused]] const ssize_t ret=write(fds[1], "x", 1);
+
+            {
+                std::lock_guard lock(sqLock);
+                io_uring_sqe* sqe=GetSqe();
+                if (sqe==nullptr) {
+                    close(fds[1]);
+                    close(fds[0]);
+                    return false;
+                }
+                sqe->opcode=IORING_OP_RECV;
+                sqe->fd=fds[0];
+                sqe->ioprio=IORING_RECV_MULTISHOT;
+                sqe->flags=IOSQE_BUFFER_SELECT;
+                sqe->buf_group=BUFFER_GROUP;
+                sqe->user_data=TAG_PROBE;
+                Submit(true);
+            }
+
+            bool supported=false;
+            bool more=true;
+            while (more) {
+                const unsigned head=*cqHead;
+                if (head==__atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                    if (Enter(ringFd, 0, 1, IORING_ENTER_GETEVENTS)<0&&errno!=EINTR) break;
+                    continue;
+                }
+
+                const io_uring_cqe cqe=cqes[head&cqMask];
+                __atomic_store_n(cqHead, head+1, __ATOMIC_RELEASE);
+                more=cqe.flags&IORING_CQE_F_MORE;
+
+                if (cqe.res>0&&(cqe.flags&IORING_CQE_F_BUFFER)) {
+                    PushBuffer(cqe.flags>>IORING_CQE_BUFFER_SHIFT);
+                    CommitBuffers();
+                    supported=more;
+                    close(fds[1]); // 对端关闭后多发recv以0结束
+                    fds[1]=-1;
+                }
+            }
+
+            if (fds[1]!=-1) close(fds[1]);
+            close(fds[0]);
+            return supported;
+        }
+
+    private:
+        int ringFd=-1;
+        void* ringPtr=MAP_FAILED;
+        size_t ringSize=0;
+        void* sqes=MAP_FAILED;
+        size_t sqesSize=0;
+
+        unsigned* sqHead=nullptr;
+        unsigned* sqTail=nullptr;
+        unsigned* sqArray=nullptr;
+        unsigned sqMask=0;
+        unsigned sqEntries=0;
+        unsigned sqLocalTail=0;
+        unsigned* cqHead=nullptr;
+        unsigned* cqTail=nullptr;
+        unsigned cqMask=0;
+        io_uring_cqe* cqes=nullptr;
+        std::deque<io_uring_cqe> reaped; // CQ溢出时GetSqe提前取出的完成事件，只由Work线程访问
+        std::mutex sqLock; // 保护提交队列、发送状态和以下推迟的请求
+
+        bool acceptPending=false; // 多发accept结束后没有空位重新投递
+        std::vector<MySocketX::LPPER_HANDLE_DATA> rearmPending; // 没有空位重新投递recv的连接
+        std::vector<SendRequest*> stalledSends; // 部分写出后没有空位继续发送的请求
+
+        void* bufRing=MAP_FAILED;
+        void* recvBuffers=MAP_FAILED;
+        unsigned short bufTail=0;
+        int currentBuffer=-1; // 正在被Work处理的接收缓冲区
+        MySocketX::LPPER_HANDLE_DATA rearm=nullptr; // 需要重新投递recv的连接
+
+        void* sendBuffers=MAP_FAILED;
+        std::vector<SendRequest> slotRequests;
+        std::vector<int> freeSlots;
+        Pool<SendRequest, 16> requestPool; // sendmsg请求
+        std::vector<MySocketX::LPPER_HANDLE_DATA> corked; // 等待发起发送的连接，由Work线程在Resubmit中发起
+
+        SOCKET listenSocket=INVALID_SOCKET;
+        bool stopped=false;
+};
+
+std::unique_ptr<MyEventLoop> CreateUringLoop() {
+    return std::make_unique<MyUringLoop>();
+}
+
+#endif
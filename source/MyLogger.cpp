@@ -1,56 +1,624 @@
 #include "MyLogger.h"
+#include "AdaptiveMutex.h"
+#include "BoundedQueue.h"
 
-#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-FILE* MyLogger::logFile=nullptr;
-Queue<std::string> MyLogger::logQueue;
-std::unique_ptr<MyThreadPool> MyLogger::pool=nullptr;
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define LOGGER_HAS_TSC
+#elif defined(__x86_64__)||defined(__i386__)
+#include <x86intrin.h>
+#define LOGGER_HAS_TSC
+#endif
 
-MyLogger::MyLogger(const bool isDebug) : debugMode(isDebug) {
-    // Initialize the thread pool with a specified number of workers and maximum jobs
-    pool=std::make_unique<MyThreadPool>(4); // Example: 4 workers
+namespace {
+    struct LogRecord {
+        long long timestamp=0; // Wall-clock nanoseconds from the configured LogClock, only for display
+        long long order=0; // Monotonic nanoseconds used to merge the rings, so a wall clock step cannot reorder a thread's lines
+        std::string line; // The formatted line, or the encoded arguments when site is set
+        uint32_t site=0;
+    };
+
+    // A MYLOG_* call site registered in binary mode; its ID is the index plus one
+    struct LogSite {
+        LogLevel level=LogLevel::Info;
+        std::string file;
+        uint32_t line=0;
+        std::string format;
+        std::string types; // One MyLoggerDetail::ArgTag per argument
+    };
+
+    // Each producer thread stages lines in its own ring, so logging never takes a shared lock
+    struct StagingRing {
+        explicit StagingRing(const unsigned int capacity):queue(capacity) {}
+
+        BoundedQueue<LogRecord> queue; // Multi-consumer so the Overwrite policy can evict from the producer side
+        std::atomic<bool> retired{false}; // Set when the owning thread exits; the writer frees the ring once drained
+    };
+
+    struct WriterState {
+        std::vector<std::shared_ptr<StagingRing>> rings;
+        std::atomic<uint32_t> ringsVersion{0}; // Bumped whenever rings changes so the writer knows to re-copy it
+        std::thread writer;
+        std::mutex mutex; // Guards rings, instances, writer start/stop and logFile
+        unsigned int instances=0;
+        unsigned int ringCapacity=LoggerConfig().ringCapacity;
+        std::atomic<LogOverflow> overflow{LogOverflow::Block};
+        std::atomic<bool> running{false};
+        std::atomic<uint32_t> wakeEpoch{0}; // The writer sleeps on this between passes
+        std::atomic<bool> wakePending{false}; // Collapses wakeups from many producers into one futex call
+        std::atomic<unsigned long long> dropped{0};
+        FILE* logFile=nullptr;
+        bool binary=false; // Set with running, the writer then encodes records instead of text
+        bool headerWritten=false; // Whether logFile already starts with the binary header
+        std::vector<LogSite> sites; // Guarded by mutex, entries are never removed
+
+        // Clock source, set before running is published and read-only while it is set
+        LogClock clock=LogClock::System;
+        long long wallBase=0; // system_clock nanoseconds at calibration
+        long long steadyBase=0;
+        unsigned long long tscBase=0;
+        double nanosPerTick=0;
+    };
+
+    // Never destroyed, so a logger released during static destruction still finds its rings and writer
+    WriterState& State() {
+        static auto* state=new WriterState();
+        return *state;
+    }
+
+    long long SystemNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    long long SteadyNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#ifdef LOGGER_HAS_TSC
+    unsigned long long ReadTsc() {return __rdtsc();}
+#endif
+
+    // Anchors the monotonic sources to the wall clock; Tsc also measures the counter rate over a short sleep
+    void CalibrateClock(WriterState& state, LogClock clock) {
+#ifndef LOGGER_HAS_TSC
+        if (clock==LogClock::Tsc) clock=LogClock::Monotonic;
+#endif
+        state.clock=clock;
+        state.wallBase=SystemNanos();
+        state.steadyBase=SteadyNanos();
+#ifdef LOGGER_HAS_TSC
+        if (clock==LogClock::Tsc) {
+            const unsigned long long tscStart=ReadTsc();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            const long long elapsed=SteadyNanos()-state.steadyBase;
+            const unsigned long long ticks=ReadTsc()-tscStart;
+            if (ticks==0) {
+                state.clock=LogClock::Monotonic;
+                return;
+            }
+            state.nanosPerTick=static_cast<double>(elapsed)/static_cast<double>(ticks);
+            state.tscBase=tscStart;
+        }
+#endif
+    }
+
+    long long WallNanos(const WriterState& state) {
+        switch (state.clock) {
+            case LogClock::Monotonic:
+                return state.wallBase+(SteadyNanos()-state.steadyBase);
+#ifdef LOGGER_HAS_TSC
+            case LogClock::Tsc:
+                return state.wallBase+static_cast<long long>(static_cast<double>(ReadTsc()-state.tscBase)*state.nanosPerTick);
+#endif
+            default:
+                return SystemNanos();
+        }
+    }
+
+    const char* LevelName(const LogLevel level) {
+        switch(level) {
+            case LogLevel::Debug:   return "DEBUG";
+            case LogLevel::Info:    return "INFO";
+            case LogLevel::Warning: return "WARNING";
+            case LogLevel::Error:   return "ERROR";
+            case LogLevel::Fatal:   return "FATAL";
+            default:                return "UNKNOWN";
+        }
+    }
+
+    void PutString(std::string& out, const std::string_view value) {
+        MyLoggerDetail::PutVarint(out, value.size());
+        out.append(value);
+    }
+
+    void PutSite(std::string& out, const uint32_t id, const LogSite& site) {
+        MyLoggerDetail::PutVarint(out, 0);
+        MyLoggerDetail::PutVarint(out, id);
+        out.push_back(static_cast<char>(site.level));
+        MyLoggerDetail::PutVarint(out, site.line);
+        PutString(out, site.file);
+        PutString(out, site.format);
+        PutString(out, site.types);
+    }
+
+    // Reads encoded values back from a staged payload
+    struct ViewReader {
+        bool Raw(char* data, const size_t size) {
+            if (in.size()<size) return false;
+            memcpy(data, in.data(), size);
+            in.remove_prefix(size);
+            return true;
+        }
+
+        std::string_view in;
+    };
+
+    // Reads encoded values back from a binary log file
+    struct FileReader {
+        bool Raw(char* data, const size_t size) {return fread(data, 1, size, in)==size;}
+
+        FILE* in;
+    };
+
+    template<class Reader>
+    bool GetVarint(Reader& in, uint64_t& value) {
+        value=0;
+        for (unsigned int shift=0;shift<64;shift+=7) {
+            char byte;
+            if (!in.Raw(&byte, 1)) return false;
+            value|=static_cast<uint64_t>(byte&0x7f)<<shift;
+            if (!(byte&0x80)) return true;
+        }
+        return false;
+    }
+
+    template<class Reader>
+    bool GetSigned(Reader& in, int64_t& value) {
+        uint64_t raw;
+        if (!GetVarint(in, raw)) return false;
+        value=static_cast<int64_t>(raw>>1^(~(raw&1)+1));
+        return true;
+    }
+
+    // Grows with the bytes actually read, so a corrupt size cannot force a huge allocation
+    template<class Reader>
+    bool GetString(Reader& in, std::string& value) {
+        uint64_t size;
+        if (!GetVarint(in, size)) return false;
+        value.clear();
+        char chunk[4096];
+        while (size>0) {
+            const size_t count=static_cast<size_t>(std::min<uint64_t>(size, sizeof(chunk)));
+            if (!in.Raw(chunk, count)) return false;
+            value.append(chunk, count);
+            size-=count;
+        }
+        return true;
+    }
+
+    // Renders one argument written by MyLoggerDetail::EncodeArg
+    template<class Reader>
+    bool DecodeArg(std::string& out, Reader& in, const MyLoggerDetail::ArgTag tag) {
+        using MyLoggerDetail::ArgTag;
+        switch (tag) {
+            case ArgTag::Int: {
+                int64_t value;
+                if (!GetSigned(in, value)) return false;
+                MyLoggerDetail::AppendArg(out, value);
+                return true;
+            }
+            case ArgTag::UInt: {
+                uint64_t value;
+                if (!GetVarint(in, value)) return false;
+                MyLoggerDetail::AppendArg(out, value);
+                return true;
+            }
+            case ArgTag::Double: {
+                double value;
+                if (!in.Raw(reinterpret_cast<char*>(&value), sizeof(value))) return false;
+                MyLoggerDetail::AppendArg(out, value);
+                return true;
+            }
+            case ArgTag::Char: {
+                char value;
+                if (!in.Raw(&value, 1)) return false;
+                MyLoggerDetail::AppendArg(out, value);
+                return true;
+            }
+            case ArgTag::Bool: {
+                char value;
+                if (!in.Raw(&value, 1)) return false;
+                MyLoggerDetail::AppendArg(out, value!=0);
+                return true;
+            }
+            case ArgTag::String: {
+                std::string value;
+                if (!GetString(in, value)) return false;
+                out.append(value);
+                return true;
+            }
+            case ArgTag::Pointer: {
+                uint64_t value;
+                if (!GetVarint(in, value)) return false;
+                MyLoggerDetail::AppendArg(out, reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // Fills the site's format with the encoded arguments, exactly as MyLoggerDetail::FormatTo would have
+    template<class Reader>
+    bool DecodeMessage(std::string& out, const LogSite& site, Reader& in) {
+        size_t pos=0;
+        MyLoggerDetail::AppendLiteral(out, site.format, pos);
+        for (const char tag:site.types) {
+            if (!DecodeArg(out, in, static_cast<MyLoggerDetail::ArgTag>(tag))) return false;
+            MyLoggerDetail::AppendLiteral(out, site.format, pos);
+        }
+        return true;
+    }
+
+    void WakeWriter(WriterState& state) {
+        if (state.wakePending.exchange(true, std::memory_order_acq_rel)) return;
+        state.wakeEpoch.fetch_add(1, std::memory_order_release);
+        FutexWake(&state.wakeEpoch);
+    }
+
+    struct RingHandle {
+        ~RingHandle() {if (ring!=nullptr) ring->retired.store(true, std::memory_order_release);}
+
+        std::shared_ptr<StagingRing> ring;
+    };
+
+    // Registering the ring on a thread's first line is the only time a producer takes the lock
+    StagingRing& LocalRing(WriterState& state) {
+        thread_local RingHandle handle;
+        if (handle.ring==nullptr) {
+            std::lock_guard lock(state.mutex);
+            handle.ring=std::make_shared<StagingRing>(state.ringCapacity);
+            state.rings.push_back(handle.ring);
+            state.ringsVersion.fetch_add(1, std::memory_order_release);
+        }
+        return *handle.ring;
+    }
+}
+
+std::atomic<int> MyLogger::runtimeLevel{static_cast<int>(LogLevel::Info)};
+std::atomic<bool> MyLogger::binaryMode{false};
+
+MyLogger::MyLogger(const bool isDebug, const LoggerConfig& config) : debugMode(isDebug) {
+    if (debugMode) SetLevel(LogLevel::Debug); // Debug lines are only written once a debug logger exists
+
+    // All loggers share one writer thread; the first one starts it with its config
+    WriterState& state=State();
+    std::lock_guard lock(state.mutex);
+    if (state.instances++==0) {
+        state.ringCapacity=config.ringCapacity;
+        state.overflow.store(config.overflow, std::memory_order_relaxed);
+        CalibrateClock(state, config.clock);
+        state.binary=config.binary;
+        binaryMode.store(config.binary, std::memory_order_relaxed);
+        state.running.store(true, std::memory_order_release);
+        state.writer=std::thread(WriterLoop, config);
+    }
+}
+
+MyLogger::~MyLogger() {
+    WriterState& state=State();
+    std::unique_lock lock(state.mutex);
+    if (--state.instances>0) return;
+
+    // The writer drains every ring, flushes and exits once it sees running cleared
+    binaryMode.store(false, std::memory_order_relaxed);
+    state.running.store(false, std::memory_order_release);
+    state.wakeEpoch.fetch_add(1, std::memory_order_release);
+    FutexWake(&state.wakeEpoch);
+    std::thread finished=std::move(state.writer);
+    lock.unlock();
+    if (finished.joinable()) finished.join();
+
+    lock.lock();
+    if (state.logFile!=nullptr) {
+        fclose(state.logFile);
+        state.logFile=nullptr;
+    }
 }
 
-std::shared_ptr<MyLogger> MyLogger::Create(const bool isDebug) {
-    return {new MyLogger(isDebug), Deleter()};
+std::shared_ptr<MyLogger> MyLogger::Create(const bool isDebug, const LoggerConfig& config) {
+    return {new MyLogger(isDebug, config), Deleter()};
 }
 
 std::string MyLogger::GetLevelString(const LogLevel level) {
-    switch(level) {
-        case LogLevel::Debug:   return "DEBUG";
-        case LogLevel::Info:    return "INFO";
-        case LogLevel::Warning: return "WARNING";
-        case LogLevel::Error:   return "ERROR";
-        case LogLevel::Fatal:   return "FATAL";
-        default:                return "UNKNOWN";
-    }
+    return LevelName(level);
 }
 
 int MyLogger::WriteLog(const LogLevel level, const std::string& message) {
-    const std::string logMessage = CurrentTime() + " [" + GetLevelString(level) + "] " + message;
+    if (!Enabled(level)) return 0;
+
+    long long timestamp;
+    std::string line=StartLine(level, message.size(), timestamp);
+    line.append(message);
+    return Commit(timestamp, std::move(line));
+}
+
+long long MyLogger::Timestamp() {
+    return WallNanos(State());
+}
 
-    pool->PushJob(Write, new std::string(logMessage));
+uint32_t MyLogger::RegisterSite(const LogLevel level, const char* file, const unsigned int line, const char* format,
+    const std::string_view types) {
+    WriterState& state=State();
+    std::lock_guard lock(state.mutex);
+    state.sites.push_back({level, file, line, format, std::string(types)});
+    return static_cast<uint32_t>(state.sites.size());
+}
+
+std::string MyLogger::StartLine(const LogLevel level, const size_t messageSize, long long& timestamp) {
+    timestamp=Timestamp();
+    const char* levelName=LevelName(level);
+    std::string line;
+    line.reserve(32+strlen(levelName)+messageSize);
+    AppendTime(line, timestamp);
+    line.append(" [").append(levelName).append("] ");
+    return line;
+}
+
+int MyLogger::Commit(const long long timestamp, std::string&& line, const uint32_t site) {
+    WriterState& state=State();
+    if (!state.running.load(std::memory_order_acquire)) return -1;
+
+    // The Monotonic and Tsc timestamps never go backwards; the system clock can be stepped, so take a steady stamp for it
+    LogRecord record{timestamp, state.clock==LogClock::System?SteadyNanos():timestamp, std::move(line), site};
+    StagingRing& ring=LocalRing(state);
+    while (!ring.queue.TryPush(std::move(record))) {
+        WakeWriter(state);
+        switch (state.overflow.load(std::memory_order_relaxed)) {
+            case LogOverflow::Drop:
+                state.dropped.fetch_add(1, std::memory_order_relaxed);
+                return -1;
+            case LogOverflow::Overwrite: {
+                LogRecord oldest;
+                if (ring.queue.TryPop(oldest)) state.dropped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            default:
+                if (!state.running.load(std::memory_order_acquire)) return -1;
+                std::this_thread::yield();
+        }
+    }
+
+    // The writer otherwise wakes once per flush interval; only hurry it when the ring is filling up
+    if (ring.queue.Size()>=ring.queue.Capacity()/2) WakeWriter(state);
     return 0; // Return 0 for success
 }
 
-std::string MyLogger::CurrentTime() {
-    const auto now=std::chrono::system_clock::now();
-    const std::time_t now_time_t=std::chrono::system_clock::to_time_t(now);
-    const std::tm now_tm=*std::localtime(&now_time_t);
+void MyLogger::SetLevel(const LogLevel level) {
+    runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void MyLogger::AppendTime(std::string& out, const long long wallNanos) {
+    // Only the microseconds change within a second, so each thread keeps the formatted date and time up to the second
+    thread_local long long cachedSecond=LLONG_MIN;
+    thread_local char prefix[20]; // "YYYY-MM-DD HH:MM:SS"
+
+    const long long second=wallNanos/1000000000;
+    if (second!=cachedSecond) {
+        const std::time_t time=static_cast<std::time_t>(second);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &local);
+        cachedSecond=second;
+    }
 
-    std::ostringstream oss;
-    oss<<std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
+    char micros[7]={'.'};
+    for (long long value=wallNanos%1000000000/1000, i=6;i>0;--i, value/=10)
+        micros[i]=static_cast<char>('0'+value%10);
+    out.append(prefix, sizeof(prefix)-1);
+    out.append(micros, sizeof(micros));
 }
 
 void MyLogger::SetFilename(const std::string& fileName) {
-    logFile=fopen(fileName.c_str(), "w");
-    if(logFile==nullptr)
+    FILE* file=fopen(fileName.c_str(), "wb");
+    if(file==nullptr)
         throw std::runtime_error("Failed to open log file");
+
+    WriterState& state=State();
+    std::lock_guard lock(state.mutex);
+    if (state.logFile!=nullptr) fclose(state.logFile);
+    state.logFile=file;
+    state.headerWritten=false;
+}
+
+unsigned long long MyLogger::DroppedCount() {
+    return State().dropped.load(std::memory_order_relaxed);
+}
+
+void MyLogger::WriterLoop(const LoggerConfig config) {
+    using Clock=std::chrono::steady_clock;
+    WriterState& state=State();
+
+    std::vector<std::shared_ptr<StagingRing>> rings;
+    uint32_t seenVersion=state.ringsVersion.load(std::memory_order_acquire)-1;
+    std::vector<LogRecord> batch;
+    std::vector<LogSite> sites; // Copy of the registered sites, refreshed when a record names a newer one
+    uint32_t sitesWritten=0; // Definitions are written in ID order, so sites 1..sitesWritten are already in the output
+    long long previousMicros=0; // Binary timestamps are deltas from the previous record in the same buffer
+    std::string buffer;
+    buffer.reserve(config.flushBytes+1024);
+    Clock::time_point flushDeadline=Clock::now()+config.flushInterval;
+
+    while (true) {
+        const uint32_t epoch=state.wakeEpoch.load(std::memory_order_acquire);
+        state.wakePending.store(false, std::memory_order_release);
+        const bool stopping=!state.running.load(std::memory_order_acquire);
+
+        if (state.ringsVersion.load(std::memory_order_acquire)!=seenVersion) {
+            std::lock_guard lock(state.mutex);
+            rings=state.rings;
+            seenVersion=state.ringsVersion.load(std::memory_order_relaxed);
+        }
+
+        // Take at most batchSize lines from each ring so one busy thread cannot starve the others
+        batch.clear();
+        bool more=false, retired=false;
+        for (const auto& ring:rings) {
+            retired|=ring->retired.load(std::memory_order_acquire);
+            LogRecord record;
+            unsigned int taken=0;
+            while (taken<config.batchSize&&ring->queue.TryPop(record)) {
+                batch.push_back(std::move(record));
+                ++taken;
+            }
+            more|=taken==config.batchSize;
+        }
+        if (retired) {
+            std::lock_guard lock(state.mutex);
+            const auto drained=[](const std::shared_ptr<StagingRing>& ring) {return ring->retired.load(std::memory_order_acquire)&&ring->queue.Empty();};
+            state.rings.erase(std::remove_if(state.rings.begin(), state.rings.end(), drained), state.rings.end());
+            rings=state.rings;
+            seenVersion=state.ringsVersion.fetch_add(1, std::memory_order_release)+1;
+        }
+
+        // Every ring is already in order, so a stable sort by the monotonic stamp interleaves them without reordering a thread's lines
+        std::stable_sort(batch.begin(), batch.end(), [](const LogRecord& a, const LogRecord& b) {return a.order<b.order;});
+        if (buffer.empty()&&!batch.empty()) flushDeadline=Clock::now()+config.flushInterval;
+        for (const LogRecord& record:batch) {
+            if (record.site>sites.size()) {
+                std::lock_guard lock(state.mutex);
+                sites=state.sites;
+            }
+            if (state.binary) {
+                // Each buffer starts from an absolute base, so it decodes correctly whichever file it lands in
+                const long long micros=record.timestamp/1000;
+                if (buffer.empty()) {
+                    MyLoggerDetail::PutVarint(buffer, 1);
+                    MyLoggerDetail::PutVarint(buffer, MyLoggerDetail::ZigZag(micros));
+                    previousMicros=micros;
+                }
+                // Sites can be first used out of registration order, or lose their first line to the overflow policy,
+                // so every earlier definition goes out too and the decoder never sees a gap in the IDs
+                for (;sitesWritten<record.site;++sitesWritten)
+                    PutSite(buffer, sitesWritten+1, sites[sitesWritten]);
+                MyLoggerDetail::PutVarint(buffer, record.site+2);
+                MyLoggerDetail::PutVarint(buffer, MyLoggerDetail::ZigZag(micros-previousMicros));
+                previousMicros=micros;
+                if (record.site==0) PutString(buffer, record.line);
+                else buffer.append(record.line);
+                continue;
+            }
+            if (record.site==0) buffer.append(record.line);
+            else {
+                const LogSite& site=sites[record.site-1];
+                AppendTime(buffer, record.timestamp);
+                buffer.append(" [").append(LevelName(site.level)).append("] ");
+                ViewReader reader{record.line};
+                DecodeMessage(buffer, site, reader);
+            }
+            buffer.push_back('\n');
+        }
+
+        const bool finished=stopping&&batch.empty();
+        if (!buffer.empty()&&(buffer.size()>=config.flushBytes||Clock::now()>=flushDeadline||finished)) {
+            Write(buffer);
+            buffer.clear();
+        }
+        if (finished) break;
+        if (more||stopping) continue;
+
+        // Sleep until a producer's ring is half full, or until buffered lines are due to be flushed
+        const auto wait=buffer.empty()?config.flushInterval:std::chrono::duration_cast<std::chrono::milliseconds>(flushDeadline-Clock::now());
+        FutexWait(&state.wakeEpoch, epoch, std::chrono::duration_cast<std::chrono::microseconds>(std::max(wait, std::chrono::milliseconds(0))).count());
+    }
+}
+
+void MyLogger::Write(const std::string& buffer) {
+    WriterState& state=State();
+    {
+        std::lock_guard lock(state.mutex);
+        if (state.logFile!=nullptr) {
+            // A new binary file starts with every site registered so far, which covers the sites the buffer refers to
+            if (state.binary&&!state.headerWritten) {
+                std::string header(MyLoggerDetail::BINARY_MAGIC, sizeof(MyLoggerDetail::BINARY_MAGIC));
+                for (uint32_t i=0;i<state.sites.size();++i) PutSite(header, i+1, state.sites[i]);
+                fwrite(header.data(), 1, header.size(), state.logFile);
+                state.headerWritten=true;
+            }
+            fwrite(buffer.data(), 1, buffer.size(), state.logFile);
+            fflush(state.logFile);
+        }
+    }
+    if (state.binary) return; // Binary records are unreadable on a terminal
+    fwrite(buffer.data(), 1, buffer.size(), stdout);
+    fflush(stdout);
 }
 
-void MyLogger::Write(void* data) {
-    const std::string* logMessage=static_cast<std::string*>(data);
-    fprintf(logFile, "%s\n", logMessage->c_str());
-    printf("%s\n", logMessage->c_str());
-}
\ No newline at end of file
+bool MyLogger::DecodeBinary(FILE* in, FILE* out) {
+    char magic[sizeof(MyLoggerDetail::BINARY_MAGIC)];
+    if (fread(magic, 1, sizeof(magic), in)!=sizeof(magic)||memcmp(magic, MyLoggerDetail::BINARY_MAGIC, sizeof(magic))!=0) return false;
+
+    FileReader reader{in};
+    std::vector<LogSite> sites;
+    std::string line, text;
+    long long micros=0;
+    for (int next=getc(in);next!=EOF;next=getc(in)) {
+        ungetc(next, in);
+        uint64_t kind;
+        if (!GetVarint(reader, kind)) return false;
+
+        if (kind==0) {
+            uint64_t id, lineNumber;
+            char level;
+            LogSite site;
+            if (!GetVarint(reader, id)||!reader.Raw(&level, 1)||!GetVarint(reader, lineNumber)||
+                !GetString(reader, site.file)||!GetString(reader, site.format)||!GetString(reader, site.types)) return false;
+            // IDs are handed out in order and a file repeats every known site up front, so a site can only extend the table by one
+            if (id==0||id>sites.size()+1||lineNumber>UINT32_MAX) return false;
+            if (level<static_cast<char>(LogLevel::Debug)||level>static_cast<char>(LogLevel::Fatal)) return false;
+            for (const char tag:site.types)
+                if (tag<static_cast<char>(MyLoggerDetail::ArgTag::Int)||tag>static_cast<char>(MyLoggerDetail::ArgTag::Pointer)) return false;
+            site.level=static_cast<LogLevel>(level);
+            site.line=static_cast<uint32_t>(lineNumber);
+            if (id>sites.size()) sites.push_back(std::move(site));
+            else sites[id-1]=std::move(site);
+            continue;
+        }
+
+        int64_t value;
+        if (!GetSigned(reader, value)) return false;
+        micros=kind==1?value:static_cast<long long>(static_cast<uint64_t>(micros)+static_cast<uint64_t>(value));
+        if (micros>LLONG_MAX/1000||micros<LLONG_MIN/1000) return false;
+        if (kind==1) continue;
+
+        line.clear();
+        if (kind==2) {
+            if (!GetString(reader, text)) return false;
+            line.append(text);
+        }
+        else {
+            if (kind-2>sites.size()) return false;
+            const LogSite& site=sites[kind-3];
+            AppendTime(line, micros*1000);
+            line.append(" [").append(LevelName(site.level)).append("] ");
+            if (!DecodeMessage(line, site, reader)) return false;
+        }
+        line.push_back('\n');
+        fwrite(line.data(), 1, line.size(), out);
+    }
+    return ferror(in)==0;
+}
@@ -1,51 +1,87 @@
 #include "MySocketX.h"
-
+#include "MyEventLoop.h"
+#include "MyThreadPool.h"
+#include "ShardedMap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
 #include <utility>
 #include <vector>
-#include <unordered_map>
+
+#ifdef _WIN32
 #include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 typedef struct {
     void* data;
     MySocketX* self;
+    int cpu; // Work线程绑定的CPU，-1表示不绑定
 }ConnectionData;
 
-typedef struct {
-    std::string message;
-    MySocketX::LPPER_HANDLE_DATA handleData{};
-}UserData;
-
 struct ClientInfo {
     SOCKET socket;
     ClientID clientId;
-    MySocketX::LPPER_HANDLE_DATA handleData; // IOCP句柄
+    MySocketX::LPPER_HANDLE_DATA handleData; // 连接句柄数据
 
     void* userData; // 用户自定义数据
 };
 
+static void PinThread(const int cpu) {
+#ifdef _WIN32
+    if (cpu<64) SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1)<<cpu);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+static int SocketError() {
+#ifdef _WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
 class MySocketX::MySocketXImpl {
     public:
         explicit MySocketXImpl(std::shared_ptr<MyLogger> logger) {
-            if (this->logger==nullptr)
-                this->logger=MyLogger::Create("log.txt");
+            if (logger==nullptr) {
+                this->logger=MyLogger::Create();
+                MyLogger::SetFilename("log.txt");
+            }
             else
                 this->logger=std::move(logger);
 
-            SYSTEM_INFO sysInfo;
-            GetSystemInfo(&sysInfo);
-            maxWorkers=sysInfo.dwNumberOfProcessors * 2;
-            threadPool=std::make_unique<MyThreadPool>(maxWorkers);// 最大线程数为CPU核心数的两倍
+            maxWorkers=std::thread::hardware_concurrency() * 2;
+            if (maxWorkers==0) maxWorkers=2;
+            // 最大线程数为CPU核心数的两倍，StartThread提交Work任务时按需创建，空闲线程超时后退出
+            ThreadPoolConfig poolConfig;
+            poolConfig.minWorker=1;
+            poolConfig.maxWorker=maxWorkers;
+            threadPool=std::make_unique<MyThreadPool>(poolConfig);
 
             listenSocket=INVALID_SOCKET;
             clientSocket=INVALID_SOCKET;
             socketType=SocketType::client;
             ipType=IPType::IPv4;
+            loopType=EventLoopType::Auto;
         }
 
-        ~MySocketXImpl()=default;
+        ~MySocketXImpl() {threadPool.reset();} // 先等待Work线程退出，再释放它们使用的事件循环
 
+#ifdef _WIN32
         WSAData& getWSAData() {return wsaData;}
-        HANDLE& getIOCP() {return iocp;}
+#endif
         SOCKET& getListenSocket() {return listenSocket;}
         SOCKET& getClientSocket() {return clientSocket;}
         SOCKADDR_IN& getServerAddr() {return serverAddr;}
@@ -55,28 +91,35 @@ class MySocketX::MySocketXImpl {
 
         SocketType& getSocketType()  {return socketType;}
         IPType& getIPType() {return ipType;}
-        CRITICAL_SECTION& getClientMapLock() {return clientMapLock;}
-
-        std::unordered_map<ClientID, ClientInfo>& getClientMap() {return clientMap;}
-        std::unordered_map<SOCKET, ClientID>& getSocket2IDMap() {return socket2IDMap;}
-
-        bool registerClient(SOCKET sock, ClientID id, void* data=nullptr) {
-            EnterCriticalSection(&clientMapLock);
-
-            auto handleData=static_cast<LPPER_HANDLE_DATA>(malloc(sizeof(PER_HANDLE_DATA)));
-            if (handleData==nullptr) {
-                LeaveCriticalSection(&clientMapLock);
+        EventLoopType& getEventLoopType() {return loopType;}
+        void*& getExtraData() {return extraData;}
+        ui& getAcceptors() {return acceptors;}
+        ui& getLoopCount() {return loopCount;}
+        bool& getPinLoops() {return pinLoops;}
+        bool& getReusePort() {return reusePort;}
+
+        ShardedMap<ClientID, ClientInfo>& getClientMap() {return clientMap;}
+        ShardedMap<SOCKET, ClientID>& getSocket2IDMap() {return socket2IDMap;}
+
+        bool registerClient(SOCKET sock, ClientID id, void* data=nullptr, MyEventLoop* loop=nullptr) {
+            // 连接上下文从所属事件循环的池中分配
+            if (loop==nullptr) loop=pickLoop(nullptr);
+            LPPER_HANDLE_DATA handleData=nullptr;
+            try {
+                handleData=loop->getHandlePool().Acquire();
+                handleData->recvData=loop->getIoPool().Acquire();
+            }
+            catch (const std::bad_alloc&) {
+                loop->getHandlePool().Release(handleData);
                 return false;
             }
 
-            ZeroMemory(handleData, sizeof(PER_HANDLE_DATA));
             handleData->socket=sock;
-
-            if (!CreateIoCompletionPort((HANDLE)INVALID_HANDLE_VALUE, nullptr, reinterpret_cast<ULONG_PTR>(handleData), 0)) {
-                free(handleData);
-                LeaveCriticalSection(&clientMapLock);
-                return false;
-            }
+            handleData->clientId=id;
+            handleData->loop=loop;
+            handleData->recvData->socket=sock;
+            handleData->recvData->clientId=id;
+            handleData->recvData->state=ProcessState::RECEIVE;
 
             // 添加映射
             ClientInfo clientInfo{};
@@ -85,49 +128,184 @@ class MySocketX::MySocketXImpl {
             clientInfo.handleData=handleData;
             clientInfo.userData=data;
 
-            clientMap[id]=clientInfo;
-            socket2IDMap[sock]=id;
+            clientMap.Insert(id, clientInfo);
+            socket2IDMap.Insert(sock, id);
 
-            free(handleData);
-            LeaveCriticalSection(&clientMapLock);
             return true;
         }
 
+        // 删除时持有所在分片的写锁，返回后不会再有SendTo访问该连接
         void unregisterClient(ClientID id) {
-            EnterCriticalSection(&clientMapLock);
-
-            auto it=clientMap.find(id);
-            if (it!=clientMap.end()) {
-                SOCKET sock=it->second.socket;
-                clientMap.erase(it);
-                socket2IDMap.erase(sock);
-                free(it->second.handleData);
-            }
-
-            LeaveCriticalSection(&clientMapLock);
+            ClientInfo clientInfo{};
+            if (clientMap.Erase(id, &clientInfo))
+                socket2IDMap.Erase(clientInfo.socket);
         }
 
         ClientID getClientID(SOCKET sock) {
-            EnterCriticalSection(&clientMapLock);
-            auto it=socket2IDMap.find(sock);
-            ClientID id=(it!=socket2IDMap.end())?it->second:-1;
-            LeaveCriticalSection(&clientMapLock);
+            ClientID id=-1;
+            socket2IDMap.Find(sock, id);
             return id;
         }
 
-        void Log(const LogLevel level, const std::string& msg) {MyLogger::WriteLog(level, msg);}
-        void StartThread(void (*Function)(void*), MySocketX* self) {
-            connections.resize(maxWorkers, {&iocp, self});
-            for (int i=1;i<=maxWorkers;++i)
-                threadPool->PushJob(Function, &(connections[i-1]));
+        LPPER_HANDLE_DATA getHandleData(SOCKET sock) {
+            ClientInfo clientInfo{};
+            if (!clientMap.Find(getClientID(sock), clientInfo)) return nullptr;
+            return clientInfo.handleData;
+        }
+
+        bool listenInLoop() {
+            // 前acceptors个事件循环负责接受连接，开启SO_REUSEPORT时各自持有一个监听套接字
+            const ui count=std::max(1u, std::min<ui>(acceptors, loops.size()));
+            for (ui i=0;i<count;++i) {
+                SOCKET sock=listenSocket;
+                if (i>0&&reusePort) {
+                    sock=createShard();
+                    if (sock==INVALID_SOCKET) return i>0;
+                }
+                if (!loops[i]->Listen(sock)) return i>0;
+            }
+            return true;
+        }
+
+        // 单个接受者时轮询分配事件循环，多个接受者时连接留在接受它的循环
+        MyEventLoop* pickLoop(MyEventLoop* loop) {
+            if (loop==nullptr||acceptors<=1)
+                loop=loops[nextLoop.fetch_add(1, std::memory_order_relaxed)%loops.size()].get();
+            return loop;
+        }
+
+        bool attachClient(LPPER_HANDLE_DATA handleData) {
+            if (!handleData->loop->Attach(handleData)) return false;
+            handleData->loop->AddMember(handleData);
+            return true;
+        }
+
+        // 在连接所属的Work线程中调用，连接可能已在投递后关闭
+        void sendInLoop(const ClientID id, const SharedPayload& payload) {
+            clientMap.Visit(id, [&](const ClientInfo& clientInfo) {
+                const LPPER_HANDLE_DATA handleData=clientInfo.handleData;
+                if (!handleData->loop->Send(handleData, payload->data(), payload->size(), &payload))
+                    MYLOG_ERROR("Send failed or send queue full (ClientID: {}).", id);
+            });
+        }
+
+        void broadcast(const SharedPayload& payload, const std::string& group) {
+            for (const auto& loop : loops) {
+                MyEventLoop* target=loop.get();
+                target->Post([target, payload, group] {
+                    const ui failed=target->FanOut(payload, group);
+                    if (failed>0)
+                        MYLOG_WARNING("Broadcast skipped {} clients (send queue full).", failed);
+                });
+            }
+        }
+
+        ContextPoolStats poolStats() {
+            ContextPoolStats stats{};
+            for (const auto& loop : loops) {
+                stats.handlesInUse+=loop->getHandlePool().InUse();
+                stats.handlesHighWater+=loop->getHandlePool().HighWater();
+                stats.ioInUse+=loop->getIoPool().InUse();
+                stats.ioHighWater+=loop->getIoPool().HighWater();
+                stats.capacity+=loop->getHandlePool().Capacity()+loop->getIoPool().Capacity();
+            }
+            return stats;
+        }
+
+        void closeShards() {
+            for (const SOCKET sock : shardSockets) {
+#ifndef _WIN32
+                shutdown(sock, SHUT_RDWR);
+#endif
+                closesocket(sock);
+            }
+            shardSockets.clear();
+        }
+
+        void closeClient(LPPER_HANDLE_DATA handleData) {
+            // 先移除映射，等待进行中的SendTo和广播结束，之后再关闭和释放
+            unregisterClient(handleData->clientId);
+            MyEventLoop* loop=handleData->loop;
+            const SOCKET sock=handleData->socket;
+            const LPPER_IO_DATA recvData=handleData->recvData;
+            loop->RemoveMember(handleData);
+
+            // Detach返回后handleData可能随发送完成被后端释放，不再访问
+            const bool release=loop->Detach(handleData);
+            closesocket(sock);
+            loop->getIoPool().Release(recvData);
+            if (release) loop->getHandlePool().Release(handleData);
+        }
+
+        void setReusePort(SOCKET sock) const {
+#ifdef SO_REUSEPORT
+            constexpr int reuse=1;
+            if (reusePort) setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+#endif
+        }
+
+        // 绑定到同一地址的额外监听套接字，由内核在各套接字间分配新连接
+        SOCKET createShard() {
+            SOCKET sock=socket((ipType==IPType::IPv4)?AF_INET:AF_INET6, SOCK_STREAM, 0);
+            if (sock==INVALID_SOCKET) return INVALID_SOCKET;
+
+            setReusePort(sock);
+            const auto addr=(ipType==IPType::IPv4)?reinterpret_cast<SOCKADDR*>(&serverAddr):reinterpret_cast<SOCKADDR*>(&serverAddr6);
+            const socklen_t addrSize=(ipType==IPType::IPv4)?sizeof(SOCKADDR_IN):sizeof(SOCKADDR_IN6);
+            if (bind(sock, addr, addrSize)==SOCKET_ERROR||listen(sock, SOMAXCONN)==SOCKET_ERROR) {
+                closesocket(sock);
+                return INVALID_SOCKET;
+            }
+
+            shardSockets.push_back(sock);
+            return sock;
+        }
+        bool StartThread(void (*Function)(void*), MySocketX* self) {
+            // IOCP默认由所有线程共享一个完成端口，epoll和io_uring每个线程独占一个循环
+            // SetLoops指定数量时按该数量创建独占循环，线程池最多提供maxWorkers个线程
+            const ui count=loopCount>0?std::min(loopCount, maxWorkers):maxWorkers;
+            loops.clear();
+            stopped=false;
+            do {
+                auto loop=MyEventLoop::Create(loopType, loopCount>0);
+                if (loop==nullptr) return false;
+                loops.push_back(std::move(loop));
+            } while (!loops.front()->Shared()&&loops.size()<count);
+
+            // 共享循环由maxWorkers个线程等待，否则每个循环一个线程
+            workers=loops.front()->Shared()?maxWorkers:static_cast<ui>(loops.size());
+            const ui cpus=std::max(1u, std::thread::hardware_concurrency());
+            connections.clear();
+            for (ui i=0;i<workers;++i)
+                connections.push_back({loops[i%loops.size()].get(), self, pinLoops?static_cast<int>(i%cpus):-1});
+            for (ui i=0;i<workers;++i)
+                threadPool->Post([Function, connection=&connections[i]] {Function(connection);}, Priority::Realtime);
+            return true;
+        }
+
+        void StopThread() {
+            for (const auto& loop : loops) {
+                loop->Close();
+                loop->Stop(workers);
+            }
+
+            std::lock_guard lock(stopLock);
+            stopped=true;
+            stopCond.notify_all();
+        }
+
+        void WaitStop() {
+            std::unique_lock lock(stopLock);
+            stopCond.wait(lock, [this] {return stopped;});
         }
 
     private:
         std::unique_ptr<MyThreadPool> threadPool;
         std::shared_ptr<MyLogger> logger;
 
+#ifdef _WIN32
         WSAData wsaData{};
-        HANDLE iocp{};
+#endif
         SOCKET listenSocket;
         SOCKET clientSocket;
         SOCKADDR_IN serverAddr{};
@@ -137,13 +315,25 @@ class MySocketX::MySocketXImpl {
 
         SocketType socketType;
         IPType ipType;
+        EventLoopType loopType;
+        void* extraData=nullptr; // Start传入的用户数据
+        ui acceptors=1;
+        ui loopCount=0; // 0表示按后端默认
+        bool pinLoops=false;
+        bool reusePort=false;
+        std::vector<SOCKET> shardSockets; // SO_REUSEPORT额外的监听套接字
 
         unsigned maxWorkers;
+        ui workers=0; // 实际启动的Work线程数
         std::vector<ConnectionData> connections;
-
-        std::unordered_map<ClientID, ClientInfo> clientMap;
-        std::unordered_map<SOCKET, ClientID> socket2IDMap;
-        CRITICAL_SECTION clientMapLock{}; // 保护clientMap和socket2IDMap的锁
+        std::vector<std::unique_ptr<MyEventLoop>> loops;
+        std::atomic<ui> nextLoop{0}; // 多个接受者线程并发分配
+        std::mutex stopLock;
+        std::condition_variable stopCond;
+        bool stopped=false;
+
+        ShardedMap<ClientID, ClientInfo> clientMap; // 按ID分片，SendTo只持有所在分片的读锁
+        ShardedMap<SOCKET, ClientID> socket2IDMap;
 };
 
 void MySocketX::Deleter::operator()(const MySocketXImpl *p) const {
@@ -162,37 +352,60 @@ MySocketX::~MySocketX() {
 
 bool MySocketX::Initialize() {
     // 初始化
+#ifdef _WIN32
     if (WSAStartup(MAKEWORD(2, 2), &impl->getWSAData())!=0) {
-        impl->Log(LogLevel::Fatal, "WSAStartup failed: "+std::to_string(WSAGetLastError()));
+        MYLOG_FATAL("WSAStartup failed: {}", SocketError());
 
         return false;
     }
-    impl->Log(LogLevel::Debug, "Socket initialized successfully.");
+#else
+    signal(SIGPIPE, SIG_IGN); // 对端关闭后的写操作返回错误而不是终止进程
+#endif
+    MYLOG_DEBUG("Socket initialized successfully.");
 
     return true;
 }
 
+void MySocketX::SetEventLoop(const EventLoopType type) {
+    impl->getEventLoopType()=type;
+}
+
+void MySocketX::SetLoops(const ui count, const bool pin) {
+    impl->getLoopCount()=count>0?count:std::max(1u, std::thread::hardware_concurrency());
+    impl->getPinLoops()=pin;
+}
+
+void MySocketX::SetAcceptors(const ui count, const bool reusePort) {
+    impl->getAcceptors()=count;
+    impl->getReusePort()=reusePort;
+}
+
 bool MySocketX::Create(const ProtocolType protocolType, const std::string& IP, unsigned port,
     const SocketType socketType, const IPType ipType) {
 
     // 服务端实现
     if (socketType==SocketType::server) {
-        auto& iocp=impl->getIOCP();
-        iocp=CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
-        if (iocp==nullptr) {
-            impl->Log(LogLevel::Fatal, "Creating IoCompletionPort failed: "+std::to_string(GetLastError()));
-            return false;
-        }
-
         SOCKET& listenSocket=impl->getListenSocket();
+#ifdef _WIN32
         listenSocket=WSASocketA((ipType==IPType::IPv4)?AF_INET:AF_INET6,
             (protocolType==ProtocolType::TCP)?SOCK_STREAM:SOCK_DGRAM, 0,
             nullptr, 0, WSA_FLAG_OVERLAPPED);
+#else
+        listenSocket=socket((ipType==IPType::IPv4)?AF_INET:AF_INET6,
+            (protocolType==ProtocolType::TCP)?SOCK_STREAM:SOCK_DGRAM, 0);
+#endif
         if (listenSocket==INVALID_SOCKET) {
-            impl->Log(LogLevel::Fatal, "WSASocket failed: "+std::to_string(WSAGetLastError()));
+            MYLOG_FATAL("WSASocket failed: {}", SocketError());
             return false;
         }
-        impl->Log(LogLevel::Debug, "Socket created successfully.");
+
+#ifndef _WIN32
+        // 允许服务重启后立即重新绑定端口
+        constexpr int reuse=1;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+        impl->setReusePort(listenSocket);
+        MYLOG_DEBUG("Socket created successfully.");
 
         // 绑定地址
         if (ipType==IPType::IPv4) {
@@ -203,11 +416,11 @@ bool MySocketX::Create(const ProtocolType protocolType, const std::string& IP, u
             inet_pton(AF_INET, IP.c_str(), &serverAddr.sin_addr);
 
             if (bind(listenSocket, reinterpret_cast<SOCKADDR *>(&serverAddr), sizeof(serverAddr))==SOCKET_ERROR) {
-                impl->Log(LogLevel::Fatal, "bind failed: "+std::to_string(WSAGetLastError()));
+                MYLOG_FATAL("bind failed: {}", SocketError());
                 return false;
             }
 
-            impl->Log(LogLevel::Info, "Socket bound successfully("+IP+":"+std::to_string(port)+").");
+            MYLOG_INFO("Socket bound successfully({}:{}).", IP, port);
         }
 
         if (ipType==IPType::IPv6) {
@@ -218,11 +431,11 @@ bool MySocketX::Create(const ProtocolType protocolType, const std::string& IP, u
             inet_pton(AF_INET6, IP.c_str(), &serverAddr6.sin6_addr);
 
             if (bind(impl->getListenSocket(), reinterpret_cast<SOCKADDR *>(&serverAddr6), sizeof(serverAddr6))==SOCKET_ERROR) {
-                impl->Log(LogLevel::Fatal, "bind failed: "+std::to_string(WSAGetLastError()));
+                MYLOG_FATAL("bind failed: {}", SocketError());
                 return false;
             }
 
-            impl->Log(LogLevel::Info, "Socket bound successfully("+IP+":"+std::to_string(port)+").");
+            MYLOG_INFO("Socket bound successfully({}:{}).", IP, port);
         }
     }
 
@@ -233,7 +446,7 @@ bool MySocketX::Create(const ProtocolType protocolType, const std::string& IP, u
             auto& clientAddr=impl->getClientAddr();
             clientSocket=socket(AF_INET, (protocolType==ProtocolType::TCP)?SOCK_STREAM:SOCK_DGRAM, 0);
             if (clientSocket==INVALID_SOCKET) {
-                impl->Log(LogLevel::Fatal, "socket failed: "+std::to_string(WSAGetLastError()));
+                MYLOG_FATAL("socket failed: {}", SocketError());
                 return false;
             }
 
@@ -246,7 +459,7 @@ bool MySocketX::Create(const ProtocolType protocolType, const std::string& IP, u
             auto& clientAddr6=impl->getClientAddr6();
             clientSocket=socket(AF_INET6, (protocolType==ProtocolType::TCP)?SOCK_STREAM:SOCK_DGRAM, 0);
             if (clientSocket==INVALID_SOCKET) {
-                impl->Log(LogLevel::Fatal, "socket failed: "+std::to_string(WSAGetLastError()));
+                MYLOG_FATAL("socket failed: {}", SocketError());
                 return false;
             }
 
@@ -255,7 +468,7 @@ bool MySocketX::Create(const ProtocolType protocolType, const std::string& IP, u
             clientAddr6.sin6_port=htons(port);
         }
     }
-    impl->Log(LogLevel::Debug, "Socket created successfully.");
+    MYLOG_DEBUG("Socket created successfully.");
 
     impl->getSocketType()=socketType;
     impl->getIPType()=ipType;
@@ -266,65 +479,47 @@ bool MySocketX::Create(const ProtocolType protocolType, const std::string& IP, u
 bool MySocketX::Start(void* data) {
     // 服务端实现
     if (impl->getSocketType()==SocketType::server) {
-        auto& clientSocket=impl->getClientSocket();
         auto& listenSocket=impl->getListenSocket();
-        int clientAddrSize=sizeof(clientSocket);
-        LPPER_HANDLE_DATA handleData;
-        LPPER_IO_DATA lpIoData;
-        HANDLE completionPort=impl->getIOCP();
-        DWORD flags=0;
+        SOCKET clientSocket=INVALID_SOCKET;
+        socklen_t clientAddrSize;
 
-        impl->StartThread(Work, this);
+        impl->getExtraData()=data;
+        if (!impl->StartThread(Work, this)) {
+            MYLOG_FATAL("Creating event loop failed: {}", SocketError());
+            return false;
+        }
 
         // 监听端口
         if (listen(impl->getListenSocket(), SOMAXCONN)==SOCKET_ERROR) {
-            impl->Log(LogLevel::Fatal, "listen failed: "+std::to_string(WSAGetLastError()));
+            MYLOG_FATAL("listen failed: {}", SocketError());
             return false;
         }
-        impl->Log(LogLevel::Info, "Listening for connections...");
+        MYLOG_INFO("Listening for connections...");
+
+        // 事件循环支持接受连接时阻塞到Close
+        if (impl->listenInLoop()) {
+            impl->WaitStop();
+            return true;
+        }
 
         while (true) {
             // 接受连接
-            if (impl->getIPType()==IPType::IPv4)
+            if (impl->getIPType()==IPType::IPv4) {
+                clientAddrSize=sizeof(SOCKADDR_IN);
                 clientSocket=accept(listenSocket, reinterpret_cast<SOCKADDR*>(&impl->getClientAddr()), &clientAddrSize);
-            if (impl->getIPType()==IPType::IPv6)
+            }
+            if (impl->getIPType()==IPType::IPv6) {
+                clientAddrSize=sizeof(SOCKADDR_IN6);
                 clientSocket=accept(listenSocket, reinterpret_cast<SOCKADDR*>(&impl->getClientAddr6()), &clientAddrSize);
+            }
 
             if (clientSocket==INVALID_SOCKET) {
-                impl->Log(LogLevel::Info, "accept failed: "+std::to_string(WSAGetLastError()));
+                if (impl->getListenSocket()==INVALID_SOCKET) break; // 已调用Close
+                MYLOG_INFO("accept failed: {}", SocketError());
                 continue; // 继续等待连接
             }
 
-            // 关联IOCP
-            handleData=static_cast<LPPER_HANDLE_DATA>(malloc(clientAddrSize));
-            handleData->socket=clientSocket;
-
-            CreateIoCompletionPort(reinterpret_cast<HANDLE>(clientSocket), completionPort, reinterpret_cast<ULONG_PTR>(handleData), 0);
-
-            // 初始化缓冲区
-            lpIoData=static_cast<LPPER_IO_DATA>(malloc(sizeof(PER_IO_DATA)));
-            ZeroMemory(&(lpIoData->overlapped), sizeof(WSAOVERLAPPED));
-            lpIoData->wsabuf.buf=lpIoData->buffer;
-            lpIoData->wsabuf.len=sizeof(lpIoData->buffer);
-            lpIoData->bytesReceived=0;
-            lpIoData->bytesSent=0;
-            lpIoData->socket=clientSocket;
-            flags=0;
-
-            // 保存连接
-            SaveClientInfo(clientSocket, data);
-
-            // 投递接收请求
-            if (WSARecv(clientSocket, &(lpIoData->wsabuf), 1, &(lpIoData->bytesReceived), &flags,
-                &(lpIoData->overlapped), nullptr)==SOCKET_ERROR) {
-                if (WSAGetLastError()!=WSA_IO_PENDING) {
-                    impl->Log(LogLevel::Error, "WSARecv failed: "+std::to_string(WSAGetLastError()));
-                    closesocket(clientSocket);
-                    free(handleData);
-                    free(lpIoData);
-                    closesocket(clientSocket);
-                }
-            }
+            AcceptClient(clientSocket);
         }
     }
 
@@ -333,12 +528,13 @@ bool MySocketX::Start(void* data) {
         // 尝试连接
         unsigned Count=0;
         while(++Count<=3) {
-            impl->Log(LogLevel::Info, "Trying to connect("+std::to_string(++Count)+")...");
+            ++Count; // 日志参数在级别关闭时不会求值，递增不能放在参数里
+            MYLOG_INFO("Trying to connect({})...", Count);
 
             if (connect(impl->getClientSocket(),
                 (impl->getIPType()==IPType::IPv4)?reinterpret_cast<SOCKADDR*>(&impl->getClientAddr()):reinterpret_cast<SOCKADDR*>(&impl->getClientAddr6()),
                 (impl->getIPType()==IPType::IPv4)?sizeof(SOCKADDR_IN):sizeof(SOCKADDR_IN6))==SOCKET_ERROR) {
-                impl->Log(LogLevel::Error, "connect failed: "+std::to_string(WSAGetLastError()));
+                MYLOG_ERROR("connect failed: {}", SocketError());
 
                 return false;
             }
@@ -347,10 +543,10 @@ bool MySocketX::Start(void* data) {
         }
 
         if (Count>3) {
-            impl->Log(LogLevel::Error, "Failed to connect after 3 attempts.");
+            MYLOG_ERROR("Failed to connect after 3 attempts.");
             return false;
         }
-        impl->Log(LogLevel::Info, "Connected successfully.");
+        MYLOG_INFO("Connected successfully.");
 
         // 数据处理（自定义）
         Process();
@@ -360,89 +556,102 @@ bool MySocketX::Start(void* data) {
 }
 
 bool MySocketX::SendTo(const std::string& data, ClientID id) {
-    EnterCriticalSection(&impl->getClientMapLock());
+    // 持有所在分片的读锁发送，连接关闭时的删除会等待发送返回
+    // 数据大小不限，无法立即写出的部分在连接的发送队列中排队，积压超过SEND_QUEUE_LIMIT时失败
+    bool sent=false;
+    const bool found=impl->getClientMap().Visit(id, [&](const ClientInfo& clientInfo) {
+        const LPPER_HANDLE_DATA handleData=clientInfo.handleData;
+        MyEventLoop* loop=handleData->loop;
+        if (loop->Shared()||loop->InLoop()) {
+            sent=loop->Send(handleData, data.data(), data.length());
+            return;
+        }
 
-    auto it=impl->getClientMap().find(id);
-    if (it==impl->getClientMap().end()) {
-        LeaveCriticalSection(&impl->getClientMapLock());
-        impl->Log(LogLevel::Error, "Client ID not found: "+std::to_string(id));
-        return false;
-    }
+        // 连接属于其他Work线程，投递到其邮箱由所属线程发送，结果只记录日志
+        auto payload=std::make_shared<const std::string>(data);
+        loop->Post([id, payload] {impl->sendInLoop(id, payload);});
+        sent=true;
+    });
 
-    ClientInfo& clientInfo=it->second;
-    auto lpIoData=static_cast<LPPER_IO_DATA>(malloc(sizeof(PER_IO_DATA)));
-    if (lpIoData==nullptr) {
-        LeaveCriticalSection(&impl->getClientMapLock());
-        impl->Log(LogLevel::Error, "Memory allocation failed for PER_IO_DATA.");
-        free(lpIoData);
+    if (!found) {
+        MYLOG_ERROR("Client ID not found: {}", id);
         return false;
     }
 
-    ZeroMemory(&(lpIoData->overlapped), sizeof(WSAOVERLAPPED));
-
-    if (data.size()>1020) {
-        LeaveCriticalSection(&impl->getClientMapLock());
-        impl->Log(LogLevel::Error, "Data size exceeds limit: "+std::to_string(data.size()));
-        free(lpIoData);
+    if (!sent) {
+        MYLOG_ERROR("Send failed or send queue full (ClientID: {}).", id);
         return false;
     }
 
-    memccpy(lpIoData->buffer, data.c_str(), sizeof(lpIoData->buffer), data.length());
-    lpIoData->wsabuf.buf=lpIoData->buffer;
-    lpIoData->wsabuf.len=static_cast<ULONG>(data.length());
-    lpIoData->state=ProcessState::SEND;
+    MYLOG_INFO("Send successfully (ClientID: {}).", id);
+    return true;
+}
 
-    LeaveCriticalSection(&impl->getClientMapLock());
+void MySocketX::AcceptClient(SOCKET sock, MyEventLoop* loop) {
+    // 保存连接
+    SaveClientInfo(sock, impl->getExtraData(), loop);
+    const LPPER_HANDLE_DATA handleData=impl->getHandleData(sock);
+    if (handleData==nullptr) return;
 
-    DWORD bytesWritten=0;
-    if (WSASend(clientInfo.socket, &(lpIoData->wsabuf), 1, &bytesWritten, 0,
-        &(lpIoData->overlapped), nullptr)==SOCKET_ERROR) {
-        if (WSAGetLastError()!=WSA_IO_PENDING) {
-            impl->Log(LogLevel::Error, "WSASend failed: "+std::to_string(WSAGetLastError()));
-            free(lpIoData);
-            return false;
-        }
+    // 关联事件循环并投递接收请求
+    if (!impl->attachClient(handleData)) {
+        MYLOG_ERROR("Attaching client failed: {}", SocketError());
+        impl->closeClient(handleData);
     }
-
-    impl->Log(LogLevel::Info, "Send successfully (ClientID: "+std::to_string(id)+").");
-    return true;
 }
 
-void MySocketX::SaveClientInfo(SOCKET sock, void *extraData) {
+void MySocketX::SaveClientInfo(SOCKET sock, void *extraData, MyEventLoop* loop) {
     OnConnect(sock, extraData);
 
-    static ClientID nextClientID=1; // 静态变量，初始值为1
+    static std::atomic<ClientID> nextClientID{1}; // 多个事件循环会同时接受连接
 
-    ClientID clientId=nextClientID++;
+    ClientID clientId=nextClientID.fetch_add(1, std::memory_order_relaxed);
 
-    if (impl->registerClient(sock, clientId, extraData)) {
-        impl->Log(LogLevel::Info, "Client ID: "+std::to_string(clientId) + " connected.");
+    if (impl->registerClient(sock, clientId, extraData, loop)) {
+        MYLOG_INFO("Client ID: {} connected.", clientId);
     }
     else {
-        impl->Log(LogLevel::Error, "Failed to register client.");
+        MYLOG_ERROR("Failed to register client.");
         closesocket(sock);
     }
 }
 
-void MySocketX::BroadCast(const std::string& data) {
-    EnterCriticalSection(&impl->getClientMapLock());
+void MySocketX::BroadCast(const std::string& data, const std::string& group) {
+    BroadCast(std::make_shared<const std::string>(data), group);
+}
 
-    for (const auto& [id, clientInfo] : impl->getClientMap()) {
-        SendTo(data, id);
-    }
+void MySocketX::BroadCast(const SharedPayload& payload, const std::string& group) {
+    // 所有连接共用同一份负载，各事件循环只增加引用计数
+    impl->broadcast(payload, group);
+    MYLOG_INFO("Broadcast {} bytes{}{}.", payload->size(), group.empty()?"":" to group ", group);
+}
 
-    LeaveCriticalSection(&impl->getClientMapLock());
+bool MySocketX::Subscribe(ClientID id, const std::string& group) {
+    bool joined=false;
+    impl->getClientMap().Visit(id, [&](const ClientInfo& clientInfo) {
+        joined=clientInfo.handleData->loop->Join(clientInfo.handleData, group);
+    });
+    return joined;
+}
+
+bool MySocketX::Unsubscribe(ClientID id, const std::string& group) {
+    bool left=false;
+    impl->getClientMap().Visit(id, [&](const ClientInfo& clientInfo) {
+        left=clientInfo.handleData->loop->Leave(clientInfo.handleData, group);
+    });
+    return left;
 }
 
 void MySocketX::Close() {
-    impl->Log(LogLevel::Info, "Closing socket...");
+    MYLOG_INFO("Closing socket...");
 
-    if (impl->getIOCP()!=nullptr) {
-        CloseHandle(impl->getIOCP());
-        impl->getIOCP()=nullptr;
-    }
+    impl->StopThread();
+    impl->closeShards();
 
     if (impl->getListenSocket()!=INVALID_SOCKET) {
+#ifndef _WIN32
+        shutdown(impl->getListenSocket(), SHUT_RDWR); // 唤醒阻塞在accept上的线程
+#endif
         closesocket(impl->getListenSocket());
         impl->getListenSocket()=INVALID_SOCKET;
     }
@@ -452,26 +661,32 @@ void MySocketX::Close() {
         impl->getClientSocket()=INVALID_SOCKET;
     }
 
+#ifdef _WIN32
     WSACleanup();
+#endif
+}
+
+ContextPoolStats MySocketX::GetPoolStats() {
+    return impl->poolStats();
 }
 
 void MySocketX::OnConnect(SOCKET sock, void* data) {
     // 用户可重写此方法以处理新连接
     // data 为用户自定义数据，会加入到 ClientInfo 结构体中
 
-    impl->Log(LogLevel::Info, "New client connected (Socket: "+std::to_string(sock)+").");
+    MYLOG_INFO("New client connected (Socket: {}).", sock);
 }
 
 bool MySocketX::OnSend(SOCKET sock, void* data) {
     // 用户可重写此方法以处理发送完成
-    impl->Log(LogLevel::Info, "Data sent to socket: "+std::to_string(sock));
+    MYLOG_INFO("Data sent to socket: {}", sock);
 
     return SendTo(*(static_cast<std::string*>(data)), impl->getClientID(sock));
 }
 
 bool MySocketX::OnReceive(SOCKET sock, void* data) {
     // 用户可重写此方法以处理接收到的数据
-    impl->Log(LogLevel::Info, "Data received from socket: "+std::to_string(sock));
+    MYLOG_INFO("Data received from socket: {}", sock);
 
     return true;
 }
@@ -484,14 +699,14 @@ void MySocketX::Process() {
         bytesReceived=recv(impl->getClientSocket(), buffer, DATA_SIZE, 0);
         if (bytesReceived>0) {
             std::string data(buffer, bytesReceived);
-            impl->Log(LogLevel::Info, "Data received: "+data);
+            MYLOG_INFO("Data received: {}", data);
         }
         else if (bytesReceived==0) {
-            impl->Log(LogLevel::Info, "Server closed the connection.");
+            MYLOG_INFO("Server closed the connection.");
             break;
         }
         else {
-            impl->Log(LogLevel::Error, "recv failed: "+std::to_string(WSAGetLastError()));
+            MYLOG_ERROR("recv failed: {}", SocketError());
             break;
         }
     }
@@ -500,105 +715,70 @@ void MySocketX::Process() {
 void MySocketX::Work(void* data) {
     auto* connectionData=static_cast<ConnectionData*>(data);
 
-    HANDLE completionPort=*static_cast<HANDLE *>(connectionData->data);
-    DWORD transferredBytes;
-    ULONG_PTR completionKey;
+    auto* loop=static_cast<MyEventLoop*>(connectionData->data);
+    MyEventLoop::Event event{};
     LPPER_IO_DATA lpIoData;
     LPPER_HANDLE_DATA handleData;
-    uint32_t dataSize=0;
-
-    while (true) {
-        const BOOL ok=GetQueuedCompletionStatus(completionPort, &transferredBytes,
-            &completionKey, reinterpret_cast<LPOVERLAPPED *>(&lpIoData), INFINITE);
 
-        handleData=reinterpret_cast<LPPER_HANDLE_DATA>(completionKey);
+    if (connectionData->cpu>=0) PinThread(connectionData->cpu);
+
+    while (loop->Wait(event)) {
+        if (event.handleData==nullptr) {
+            // 事件循环接受的新连接，由其所属循环的线程完成注册和关联
+            MyEventLoop* target=impl->pickLoop(loop);
+            if (target==loop||target->Shared()) connectionData->self->AcceptClient(event.socket, target);
+            else {
+                // 套接字归任务所有，循环已停止导致任务未执行就被销毁时由删除器关闭
+                MySocketX* self=connectionData->self;
+                const std::shared_ptr<SOCKET> sock(new SOCKET(event.socket), [](const SOCKET* s) {
+                    if (*s!=INVALID_SOCKET) closesocket(*s);
+                    delete s;
+                });
+                if (!target->Post([self, sock, target] {self->AcceptClient(std::exchange(*sock, INVALID_SOCKET), target);}))
+                    MYLOG_WARNING("Event loop stopped, closing the accepted socket.");
+            }
+            continue;
+        }
 
-        if (lpIoData->bytesReceived<4)continue;
+        handleData=event.handleData;
+        lpIoData=handleData->recvData;
 
-        if (!ok) {
+        if (!event.ok) {
             // 连接错误或关闭
-            impl->Log(LogLevel::Error, "GetQueuedCompletionStatus failed: "+std::to_string(WSAGetLastError()));
-            closesocket(handleData->socket);
-            free(handleData);
-            free(lpIoData);
+            MYLOG_ERROR("GetQueuedCompletionStatus failed: {}", SocketError());
+            impl->closeClient(handleData);
             continue;
         }
 
-        if (transferredBytes==0) {
+        if (event.bytes==0) {
             // 客户端关闭
-            impl->Log(LogLevel::Info, "Client disconnected.");
-            closesocket(handleData->socket);
-            free(handleData);
-            free(lpIoData);
+            MYLOG_INFO("Client disconnected.");
+            impl->closeClient(handleData);
             continue;
         }
 
-        lpIoData->accumulatedData.insert(
-            lpIoData->accumulatedData.end(),
-            lpIoData->buffer,
-            lpIoData->buffer + transferredBytes);
-
-        bool continueProcessing=true;
-        UserData userData;
-
-        while (continueProcessing) {
-            switch (lpIoData->state) {
-                case ProcessState::RECEIVE:
-                    if (lpIoData->accumulatedData.size()<4) break;
-
-                    // 处理数据
-                    memcpy(&dataSize, lpIoData->accumulatedData.data(), 4);
-                    dataSize=ntohl(dataSize); // 网络字节序转主机字节序
-
-                    // 检查消息完整性
-                    if (lpIoData->accumulatedData.size()<dataSize+4) break;
-
-                    // 处理完整数据
-                    userData={lpIoData->accumulatedData, handleData};
-                    connectionData->self->OnReceive(handleData->socket, &userData);
-
-                    // 移除已处理的数据
-                    lpIoData->accumulatedData.erase(
-                        lpIoData->accumulatedData.begin(),
-                        lpIoData->accumulatedData.begin()+dataSize + 4);
-                    break;
-
-                case ProcessState::SEND:
-                    SendTo(lpIoData->accumulatedData, userData.handleData->socket);
-                    lpIoData->accumulatedData.clear();
-                    break;
-
-                case ProcessState::CLOSE:
-                    // 客户端关闭
-                    impl->Log(LogLevel::Info, "Client disconnected.");
-                    continueProcessing=false;
-                    closesocket(handleData->socket);
-                    free(handleData);
-                    free(lpIoData);
-                    break;
-
-                default: break;
-            }
-
-            if (lpIoData->state==ProcessState::RECEIVE&&lpIoData->accumulatedData.size()<4||
-                lpIoData->state==ProcessState::SEND)
-                continueProcessing=false;
+        // 完整落在本次数据中的帧直接交给OnReceive，只有不完整的帧才会被缓存
+        const bool valid=lpIoData->decoder.Feed(event.data, event.bytes,
+            [&](const char* payload, const uint32_t length) {
+                UserData userData{std::string_view(payload, length), handleData};
+                connectionData->self->OnReceive(handleData->socket, &userData);
+            });
+
+        if (!valid) {
+            // 帧长度超过上限，关闭读写后由事件循环送达关闭事件
+            MYLOG_ERROR("Frame too large, closing connection.");
+            lpIoData->decoder.Clear();
+#ifdef _WIN32
+            shutdown(handleData->socket, SD_BOTH);
+#else
+            shutdown(handleData->socket, SHUT_RDWR);
+#endif
         }
 
-        ZeroMemory(&(lpIoData->overlapped), sizeof(WSAOVERLAPPED));
-        lpIoData->wsabuf.buf=lpIoData->buffer;
-        lpIoData->wsabuf.len=sizeof(lpIoData->buffer);
-
-        DWORD flags = 0;
-        DWORD bytesReceived = 0;
-
-        if (WSARecv(handleData->socket, &(lpIoData->wsabuf), 1, &bytesReceived,
-                    &flags, &(lpIoData->overlapped), nullptr) == SOCKET_ERROR)
-            if (WSAGetLastError()!=WSA_IO_PENDING) {
-                impl->Log(LogLevel::Error, "WSARecv failed: "+std::to_string(WSAGetLastError()));
-                closesocket(handleData->socket);
-                free(handleData);
-                free(lpIoData);
-            }
+        // 继续接收
+        if (!loop->Receive(handleData)) {
+            MYLOG_ERROR("WSARecv failed: {}", SocketError());
+            impl->closeClient(handleData);
+        }
     }
 }
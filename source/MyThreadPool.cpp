@@ -0,0 +1,539 @@
+#include "MyThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+    constexpr size_t INJECT_CAPACITY=1024; // 注入队列容量，必须为2的幂
+    constexpr size_t DEQUE_CAPACITY=256; // 本地队列初始容量和节点池大小，必须为2的幂
+    constexpr int SPIN_ROUNDS=64; // 休眠前的自旋次数
+    constexpr uint32_t NORMAL_INTERVAL=8; // 每取这么多次任务优先检查一次normal队列
+    constexpr uint32_t BACKGROUND_INTERVAL=32; // 每取这么多次任务优先检查一次background队列
+
+    // 当前线程所属的线程池和序号，用于判断PushJob是否来自池内线程
+    struct CurrentWorker {
+        const void* pool;
+        ui index;
+    };
+    thread_local CurrentWorker current{nullptr, 0};
+
+    int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+// Chase-Lev工作窃取队列（Lê等人的C11内存模型版本）
+// 所有者在bottom端压入和弹出，其他线程在top端窃取；容量不足时换用两倍大小的数组，旧数组保留到析构
+// 数组中保存任务节点的指针，节点取自所有者的环形节点池，取出任务的线程负责归还；节点池用尽时临时在堆上申请
+class MyThreadPool::WorkDeque {
+    struct Node {
+        PendingTask item;
+        std::atomic<bool> used{false};
+        bool heap=false;
+    };
+
+    struct Array {
+        explicit Array(const size_t capacity):capacity(capacity), mask(capacity-1), nodes(new std::atomic<Node*>[capacity]) {}
+
+        void Put(const int64_t index, Node* node) {nodes[index&mask].store(node, std::memory_order_relaxed);}
+        [[nodiscard]] Node* Get(const int64_t index)const {return nodes[index&mask].load(std::memory_order_relaxed);}
+
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> nodes;
+    };
+
+    public:
+        WorkDeque():nodes(new Node[NODE_COUNT]) {
+            arrays.push_back(std::make_unique<Array>(DEQUE_CAPACITY));
+            array.store(arrays.back().get(), std::memory_order_relaxed);
+        }
+
+        void Push(PendingTask&& item) {
+            Node* node=Allocate();
+            node->item=std::move(item);
+
+            const int64_t b=bottom.load(std::memory_order_relaxed);
+            const int64_t t=top.load(std::memory_order_acquire);
+            Array* a=array.load(std::memory_order_relaxed);
+
+            if (b-t>static_cast<int64_t>(a->capacity)-1) a=Grow(a, t, b);
+            a->Put(b, node);
+            bottom.store(b+1, std::memory_order_release);
+        }
+
+        bool Pop(PendingTask& item) {
+            const int64_t b=bottom.load(std::memory_order_relaxed)-1;
+            Array* a=array.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t=top.load(std::memory_order_relaxed);
+
+            if (t>b) {
+                bottom.store(b+1, std::memory_order_relaxed);
+                return false;
+            }
+
+            Node* node=a->Get(b);
+            if (t==b) {
+                // 只剩最后一个任务，与窃取者竞争
+                const bool won=top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom.store(b+1, std::memory_order_relaxed);
+                if (!won) return false;
+            }
+            Take(node, item);
+            return true;
+        }
+
+        bool Steal(PendingTask& item) {
+            int64_t t=top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t b=bottom.load(std::memory_order_acquire);
+            if (t>=b) return false;
+
+            const Array* a=array.load(std::memory_order_acquire);
+            Node* node=a->Get(t);
+            if (!top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+            Take(node, item);
+            return true;
+        }
+
+        [[nodiscard]] bool Empty()const {
+            return bottom.load(std::memory_order_relaxed)<=top.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t Size()const {
+            const int64_t size=bottom.load(std::memory_order_relaxed)-top.load(std::memory_order_relaxed);
+            return size>0?static_cast<size_t>(size):0;
+        }
+
+    private:
+        Node* Allocate() {
+            Node* node=&nodes[nextNode];
+            if (node->used.load(std::memory_order_acquire)) {
+                node=new Node;
+                node->heap=true;
+                return node;
+            }
+            node->used.store(true, std::memory_order_relaxed);
+            nextNode=(nextNode+1)&(NODE_COUNT-1);
+            return node;
+        }
+
+        static void Take(Node* node, PendingTask& item) {
+            item=std::move(node->item);
+            if (node->heap) delete node;
+            else node->used.store(false, std::memory_order_release);
+        }
+
+        Array* Grow(const Array* old, const int64_t t, const int64_t b) {
+            arrays.push_back(std::make_unique<Array>(old->capacity*2));
+            Array* a=arrays.back().get();
+            for (int64_t i=t;i<b;++i)
+                a->Put(i, old->Get(i));
+            array.store(a, std::memory_order_release);
+            return a;
+        }
+
+    private:
+        static constexpr size_t NODE_COUNT=DEQUE_CAPACITY;
+
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<Array*> array{nullptr};
+        std::vector<std::unique_ptr<Array>> arrays; // 只由所有者修改，窃取者可能仍在读取旧数组
+        std::unique_ptr<Node[]> nodes;
+        size_t nextNode=0;
+};
+
+MyThreadPool::MyThreadPool():MyThreadPool(ThreadPoolConfig()) {}
+
+MyThreadPool::MyThreadPool(const ui maxWorker):MyThreadPool(ThreadPoolConfig{maxWorker, maxWorker}) {}
+
+MyThreadPool::MyThreadPool(const ThreadPoolConfig& config):config(config) {
+    if (this->config.maxWorker==0) this->config.maxWorker=std::thread::hardware_concurrency();
+    this->config.maxWorker=std::max(1u, this->config.maxWorker);
+    this->config.minWorker=std::min(this->config.minWorker, this->config.maxWorker);
+    maxWorker=this->config.maxWorker;
+    elastic=this->config.minWorker<maxWorker;
+
+    for (auto& lane : lanes)
+        lane.queue=std::make_unique<BoundedQueue<PendingTask>>(INJECT_CAPACITY);
+    workers=std::make_unique<Worker[]>(maxWorker);
+    for (ui i=0;i<maxWorker;++i)
+        workers[i].deque=std::make_unique<WorkDeque>();
+
+    for (ui i=0;i<this->config.minWorker;++i)
+        StartWorker(i);
+    if (elastic) controlThread=std::thread(&MyThreadPool::ControlLoop, this);
+}
+
+MyThreadPool::~MyThreadPool() {
+    StopAll();
+}
+
+void MyThreadPool::StopAll() {
+    terminate.store(true, std::memory_order_release);
+    Wake(true);
+
+    // 先停止控制线程，之后不会再有新线程启动
+    if (controlThread.joinable()) {
+        controlEpoch.fetch_add(1, std::memory_order_release);
+        FutexWake(&controlEpoch);
+        controlThread.join();
+    }
+
+    for (ui i=0;i<maxWorker;++i)
+        if (workers[i].thread.joinable()&&workers[i].thread.get_id()!=std::this_thread::get_id())
+            workers[i].thread.join();
+}
+
+void MyThreadPool::PushJob(void (*Function)(void*), void* Data) {
+    Post([Function, Data] {Function(Data);});
+}
+
+void MyThreadPool::Post(Task task, const Priority priority) {
+    Enqueue(PendingTask{std::move(task), Now()}, priority);
+
+    // 与休眠前的检查配对：要么线程看到新任务，要么这里看到休眠的线程
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed)>0) Wake(false);
+    else RequestSpawn();
+}
+
+void MyThreadPool::Post(Task task, const Priority priority, const std::chrono::steady_clock::time_point deadline) {
+    const int64_t deadlineNanos=std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    Enqueue(PendingTask{std::move(task), Now(), std::max<int64_t>(1, deadlineNanos)}, priority);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed)>0) Wake(false);
+    else RequestSpawn();
+}
+
+void MyThreadPool::PushJobs(Task* tasks, const size_t count, const Priority priority) {
+    if (count==0) return;
+
+    const int64_t now=Now();
+    if (current.pool==this&&priority==Priority::Normal) {
+        for (size_t i=0;i<count;++i)
+            workers[current.index].deque->Push(PendingTask{std::move(tasks[i]), now});
+    }
+    else {
+        Lane& lane=lanes[static_cast<size_t>(priority)];
+        size_t i=0;
+        for (;i<count;++i) {
+            PendingTask pending{std::move(tasks[i]), now};
+            if (!lane.queue->TryPush(std::move(pending))) { // 失败时pending保持不变
+                tasks[i]=std::move(pending.task);
+                break;
+            }
+        }
+        if (i<count) {
+            std::lock_guard lock(lane.overflowMutex);
+            for (;i<count;++i)
+                lane.overflow.push_back(PendingTask{std::move(tasks[i]), now});
+            lane.overflowSize.store(lane.overflow.size(), std::memory_order_relaxed);
+        }
+    }
+
+    // 多个任务时一次唤醒所有休眠线程，由它们互相窃取
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const ui idle=sleepers.load(std::memory_order_relaxed);
+    if (idle>0) Wake(count>1);
+    if (idle<count) RequestSpawn();
+}
+
+ThreadPoolStats MyThreadPool::Stats()const {
+    uint64_t jobs=0, waitNanos=0, maxWaitNanos=0, expired=0;
+    for (ui i=0;i<maxWorker;++i) {
+        jobs+=workers[i].jobs.load(std::memory_order_relaxed);
+        expired+=workers[i].expired.load(std::memory_order_relaxed);
+        waitNanos+=workers[i].waitNanos.load(std::memory_order_relaxed);
+        maxWaitNanos=std::max(maxWaitNanos, workers[i].maxWaitNanos.load(std::memory_order_relaxed));
+    }
+
+    return {
+        live.load(std::memory_order_relaxed),
+        sleepers.load(std::memory_order_relaxed),
+        QueuedJobs(),
+        jobs,
+        expired,
+        jobs>0?static_cast<double>(waitNanos)/static_cast<double>(jobs)/1000.0:0.0,
+        static_cast<double>(maxWaitNanos)/1000.0
+    };
+}
+
+void MyThreadPool::ThreadLoop(const ui index) {
+    current={this, index};
+    PendingTask pending;
+    const long long idleMicros=elastic?std::chrono::duration_cast<std::chrono::microseconds>(config.idleTimeout).count():-1;
+
+    while (true) {
+        bool found=false;
+        for (int spin=0;spin<SPIN_ROUNDS&&!found;++spin) {
+            found=TakeJob(index, pending);
+            if (!found&&spin>0) std::this_thread::yield();
+        }
+
+        if (found) {
+            Execute(index, pending);
+            continue;
+        }
+
+        // 停止时先执行完剩余任务
+        if (terminate.load(std::memory_order_acquire)) break;
+
+        // 先读取唤醒计数再检查任务，检查之后的唤醒会使FutexWait立即返回
+        const uint32_t epoch=wakeEpoch.load(std::memory_order_acquire);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (HasJob()||terminate.load(std::memory_order_acquire)) {
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const int64_t parked=Now();
+        FutexWait(&wakeEpoch, epoch, idleMicros);
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+        // 空闲超时后退出；不再计入休眠数后重新检查，避免提交方只唤醒了即将退出的线程
+        if (idleMicros>=0&&Now()-parked>=idleMicros*1000) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!HasJob()&&TryRetire()) {
+                workers[index].state.store(EXITED, std::memory_order_release);
+                break;
+            }
+        }
+    }
+
+    current={nullptr, 0};
+}
+
+void MyThreadPool::ControlLoop() {
+    const long long intervalMicros=std::chrono::duration_cast<std::chrono::microseconds>(config.checkInterval).count();
+    const auto spawnWaitNanos=static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(config.spawnWaitTime).count());
+    uint64_t lastJobs=0, lastWaitNanos=0;
+
+    while (!terminate.load(std::memory_order_acquire)) {
+        const uint32_t epoch=controlEpoch.load(std::memory_order_acquire);
+        if (!spawnRequested.exchange(false, std::memory_order_acq_rel))
+            FutexWait(&controlEpoch, epoch, intervalMicros);
+        if (terminate.load(std::memory_order_acquire)) break;
+
+        // 回收空闲退出的线程
+        for (ui i=0;i<maxWorker;++i)
+            if (workers[i].state.load(std::memory_order_acquire)==EXITED) {
+                workers[i].thread.join();
+                workers[i].state.store(STOPPED, std::memory_order_relaxed);
+            }
+
+        // 最近一个周期内开始执行的任务的平均等待时间
+        uint64_t jobs=0, waitNanos=0;
+        for (ui i=0;i<maxWorker;++i) {
+            jobs+=workers[i].jobs.load(std::memory_order_relaxed);
+            waitNanos+=workers[i].waitNanos.load(std::memory_order_relaxed);
+        }
+        const bool slow=jobs>lastJobs&&(waitNanos-lastWaitNanos)/(jobs-lastJobs)>spawnWaitNanos;
+        lastJobs=jobs;
+        lastWaitNanos=waitNanos;
+
+        if (sleepers.load(std::memory_order_relaxed)>0) continue;
+        const size_t queued=QueuedJobs();
+        size_t spawn=0;
+        if (queued>0&&queued>=config.spawnQueueDepth) spawn=queued;
+        else if (slow) spawn=1;
+
+        for (ui i=0;i<maxWorker&&spawn>0&&live.load(std::memory_order_relaxed)<maxWorker;++i)
+            if (workers[i].state.load(std::memory_order_relaxed)==STOPPED) {
+                StartWorker(i);
+                --spawn;
+            }
+    }
+}
+
+void MyThreadPool::StartWorker(const ui index) {
+    workers[index].state.store(RUNNING, std::memory_order_relaxed);
+    live.fetch_add(1, std::memory_order_relaxed);
+    workers[index].thread=std::thread(&MyThreadPool::ThreadLoop, this, index);
+}
+
+bool MyThreadPool::TryRetire() {
+    ui count=live.load(std::memory_order_relaxed);
+    while (count>config.minWorker)
+        if (live.compare_exchange_weak(count, count-1, std::memory_order_relaxed)) return true;
+    return false;
+}
+
+void MyThreadPool::RequestSpawn() {
+    // 所有线程都在忙且还能增加时通知控制线程，连续提交只通知一次
+    if (!elastic||live.load(std::memory_order_relaxed)>=maxWorker) return;
+    if (!spawnRequested.exchange(true, std::memory_order_acq_rel)) {
+        controlEpoch.fetch_add(1, std::memory_order_release);
+        FutexWake(&controlEpoch);
+    }
+}
+
+void MyThreadPool::Execute(const ui index, PendingTask& pending) {
+    Worker& worker=workers[index];
+    const int64_t now=Now();
+
+    if (pending.deadline!=0&&now>pending.deadline) {
+        worker.expired.store(worker.expired.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+        pending.task.Reset();
+        return;
+    }
+
+    const auto wait=static_cast<uint64_t>(std::max<int64_t>(0, now-pending.enqueueTime));
+    worker.jobs.store(worker.jobs.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+    worker.waitNanos.store(worker.waitNanos.load(std::memory_order_relaxed)+wait, std::memory_order_relaxed);
+    if (wait>worker.maxWaitNanos.load(std::memory_order_relaxed)) worker.maxWaitNanos.store(wait, std::memory_order_relaxed);
+
+    pending.task();
+    pending.task.Reset(); // 立即释放捕获的资源
+}
+
+void MyThreadPool::Enqueue(PendingTask&& pending, const Priority priority) {
+    // 池内线程提交的普通任务压入本线程队列，其他优先级进入对应的全局队列
+    if (priority==Priority::Normal&&current.pool==this) {
+        workers[current.index].deque->Push(std::move(pending));
+        return;
+    }
+
+    Lane& lane=lanes[static_cast<size_t>(priority)];
+    if (!lane.queue->TryPush(std::move(pending))) { // 失败时pending保持不变，转入后备队列
+        std::lock_guard lock(lane.overflowMutex);
+        lane.overflow.push_back(std::move(pending));
+        lane.overflowSize.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool MyThreadPool::TakeJob(const ui index, PendingTask& pending) {
+    Worker& worker=workers[index];
+    const uint32_t pick=++worker.picks;
+
+    // 定期先检查低优先级队列，高优先级任务持续到达时低优先级任务也能得到执行
+    if (pick%BACKGROUND_INTERVAL==0&&TakeFromLane(Priority::Background, pending)) return true;
+    if (pick%NORMAL_INTERVAL==0&&(worker.deque->Pop(pending)||TakeFromLane(Priority::Normal, pending))) return true;
+
+    if (TakeFromLane(Priority::Realtime, pending)) return true;
+    if (worker.deque->Pop(pending)) return true;
+    if (TakeFromLane(Priority::Normal, pending)) return true;
+    if (Steal(index, pending)) return true;
+    return TakeFromLane(Priority::Background, pending);
+}
+
+bool MyThreadPool::TakeFromLane(const Priority priority, PendingTask& pending) {
+    Lane& lane=lanes[static_cast<size_t>(priority)];
+    if (lane.queue->TryPop(pending)) return true;
+
+    if (lane.overflowSize.load(std::memory_order_relaxed)>0) {
+        std::lock_guard lock(lane.overflowMutex);
+        if (!lane.overflow.empty()) {
+            pending=std::move(lane.overflow.front());
+            lane.overflow.pop_front();
+            lane.overflowSize.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MyThreadPool::Steal(const ui index, PendingTask& pending) {
+    // 从下一个线程开始轮流窃取，避免所有线程同时争抢同一个队列
+    for (ui i=1;i<maxWorker;++i)
+        if (workers[(index+i)%maxWorker].deque->Steal(pending)) return true;
+    return false;
+}
+
+bool MyThreadPool::HasJob()const {
+    for (const auto& lane : lanes)
+        if (!lane.queue->Empty()||lane.overflowSize.load(std::memory_order_relaxed)>0) return true;
+    for (ui i=0;i<maxWorker;++i)
+        if (!workers[i].deque->Empty()) return true;
+    return false;
+}
+
+size_t MyThreadPool::QueuedJobs()const {
+    size_t queued=0;
+    for (const auto& lane : lanes)
+        queued+=lane.queue->Size()+lane.overflowSize.load(std::memory_order_relaxed);
+    for (ui i=0;i<maxWorker;++i)
+        queued+=workers[i].deque->Size();
+    return queued;
+}
+
+void MyThreadPool::Wake(const bool all) {
+    wakeEpoch.fetch_add(1, std::memory_order_release);
+    FutexWake(&wakeEpoch, all);
+}
+
+bool MyThreadPool::RunOne() {
+    if (current.pool!=this) return false;
+
+    PendingTask pending;
+    if (!TakeJob(current.index, pending)) return false;
+    Execute(current.index, pending);
+    return true;
+}
+
+size_t MyThreadPool::GrainSize(const size_t count, const size_t grain)const {
+    if (grain>0) return grain;
+    const size_t target=static_cast<size_t>(maxWorker)*4;
+    return std::max<size_t>(1, (count+target-1)/target);
+}
+
+void MyThreadPool::ForkJoin(ThreadPoolDetail::ForkState& state) {
+    using ThreadPoolDetail::ForkState;
+    state.chunks=(state.end-state.begin+state.grain-1)/state.grain;
+
+    // 调用方是池内线程时自己占用一个线程
+    const size_t helpers=std::min<size_t>(state.chunks-1, current.pool==this?maxWorker-1:maxWorker);
+    if (helpers>0) {
+        state.refs.fetch_add(static_cast<uint32_t>(helpers), std::memory_order_relaxed);
+        std::vector<Task> tasks;
+        tasks.reserve(helpers);
+        for (size_t i=0;i<helpers;++i)
+            tasks.emplace_back([&state] {
+                state.Work();
+                state.Release();
+            });
+        PushJobs(tasks.data(), tasks.size());
+    }
+
+    state.Work();
+    while (state.status.load(std::memory_order_acquire)!=ForkState::DONE) {
+        if (RunOne()) continue;
+
+        uint32_t status=ForkState::RUNNING;
+        if (state.status.compare_exchange_strong(status, ForkState::WAITING, std::memory_order_acq_rel)||status==ForkState::WAITING)
+            FutexWait(&state.status, ForkState::WAITING);
+    }
+
+    const std::exception_ptr error=state.error;
+    state.Release();
+    if (error) std::rethrow_exception(error);
+}
+
+void ThreadPoolDetail::ForkState::Work() {
+    while (true) {
+        const size_t chunk=next.fetch_add(1, std::memory_order_relaxed);
+        if (chunk>=chunks) return;
+
+        // 已有分块失败时跳过剩余分块，但仍计入完成数
+        if (!failed.load(std::memory_order_relaxed)) {
+            const size_t first=begin+chunk*grain;
+            try {
+                run(body, chunk, first, std::min(end, first+grain));
+            }
+            catch (...) {
+                if (!failed.exchange(true, std::memory_order_relaxed)) error=std::current_exception();
+            }
+        }
+
+        if (finished.fetch_add(1, std::memory_order_acq_rel)+1==chunks&&status.exchange(DONE, std::memory_order_acq_rel)==WAITING)
+            FutexWake(&status, true);
+    }
+}
+
+void ThreadPoolDetail::ForkState::Release() {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel)==1) delete this;
+}
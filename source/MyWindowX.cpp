@@ -6,8 +6,10 @@ class MyWindowX::MyWindowXImpl {
             std::shared_ptr<MyLogger> logger)
             : className(className), windowName(windowName), hInstance(instance) {
             hwnd=nullptr;
-            if (logger==nullptr)
-                this->logger=MyLogger::Create("log.txt");
+            if (logger==nullptr) {
+                this->logger=MyLogger::Create();
+                MyLogger::SetFilename("log.txt");
+            }
             else
                 this->logger=std::move(logger);
         }
@@ -0,0 +1,102 @@
+#include "MyLogger.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Returns 1 from main when a check fails, so ctest reports the test as failed
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return 1; \
+        } \
+    } while (0)
+
+namespace {
+    const char* const BINARY_FILE="MyLoggerTest.bin";
+
+    // Decodes the binary file and returns each line without its "YYYY-MM-DD HH:MM:SS.uuuuuu " prefix
+    bool DecodeMessages(std::vector<std::string>& messages) {
+        FILE* in=fopen(BINARY_FILE, "rb");
+        if (in==nullptr) return false;
+        FILE* out=tmpfile();
+        const bool decoded=out!=nullptr&&MyLogger::DecodeBinary(in, out);
+        fclose(in);
+        if (!decoded) {
+            if (out!=nullptr) fclose(out);
+            return false;
+        }
+
+        rewind(out);
+        char line[1024];
+        while (fgets(line, sizeof(line), out)!=nullptr) {
+            std::string message(line);
+            if (!message.empty()&&message.back()=='\n') message.pop_back();
+            messages.push_back(message.size()>27?message.substr(27):message);
+        }
+        fclose(out);
+        return true;
+    }
+
+    // Sites are registered after the file header went out, then first used in reverse order
+    int OutOfOrderFirstUse() {
+        LoggerConfig config;
+        config.binary=true;
+        config.flushInterval=std::chrono::milliseconds(1);
+        MyLogger::SetFilename(BINARY_FILE);
+        {
+            const auto logger=MyLogger::Create(false, config);
+            MyLogger::WriteLog(LogLevel::Info, "header");
+            std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Let the writer flush the header and this line
+
+            const uint32_t first=MyLogger::RegisterSite(LogLevel::Info, __FILE__, __LINE__, "first {}",
+                decltype(MyLoggerDetail::ArgTypesOf("first {}", 0))::Tags());
+            const uint32_t second=MyLogger::RegisterSite(LogLevel::Warning, __FILE__, __LINE__, "second {} {}",
+                decltype(MyLoggerDetail::ArgTypesOf("second {} {}", 0, ""))::Tags());
+            const uint32_t third=MyLogger::RegisterSite(LogLevel::Error, __FILE__, __LINE__, "third {}",
+                decltype(MyLoggerDetail::ArgTypesOf("third {}", 0.5))::Tags());
+            CHECK(second==first+1&&third==second+1);
+
+            CHECK(MyLogger::LogBinary(third, "third {}", 0.5)==0);
+            CHECK(MyLogger::LogBinary(second, "second {} {}", -7, "x")==0);
+            CHECK(MyLogger::LogBinary(first, "first {}", 1)==0);
+            MyLogger::WriteLog(LogLevel::Info, "plain");
+        }
+
+        std::vector<std::string> messages;
+        CHECK(DecodeMessages(messages));
+        const std::vector<std::string> expected={"[INFO] header", "[ERROR] third 0.5", "[WARNING] second -7 x", "[INFO] first 1", "[INFO] plain"};
+        CHECK(messages==expected);
+        return 0;
+    }
+
+    // Every argument type survives the encoding, through the MYLOG_* macros
+    int ArgumentRoundTrip() {
+        enum class Color {Red=2};
+        LoggerConfig config;
+        config.binary=true;
+        MyLogger::SetFilename(BINARY_FILE);
+        {
+            const auto logger=MyLogger::Create(false, config);
+            const std::string text="str";
+            MYLOG_INFO("{} {} {} {} {} {} {} {} {{}}", -42, 42u, 1.5, 'c', true, text, "lit", Color::Red);
+            MYLOG_DEBUG("skipped {}", 1);
+        }
+
+        std::vector<std::string> messages;
+        CHECK(DecodeMessages(messages));
+        const std::vector<std::string> expected={"[INFO] -42 42 1.5 c true str lit 2 {}"};
+        CHECK(messages==expected);
+        return 0;
+    }
+}
+
+int main() {
+    int failed=0;
+    failed+=OutOfOrderFirstUse();
+    failed+=ArgumentRoundTrip();
+    remove(BINARY_FILE);
+    return failed==0?0:1;
+}